@@ -0,0 +1,106 @@
+#include "sudokuSolver.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Counts every call into the global allocator made while the benchmark runs
+static std::size_t allocationCount = 0;
+
+void* operator new(std::size_t size){
+    ++allocationCount;
+    if(void* memory = std::malloc(size == 0 ? 1 : size)){
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// Solves the puzzle once on a fresh solver, which lives on the stack
+static bool solvePuzzle(const std::string& puzzle){
+    SudokuSolver sudokuSolver;
+    sudokuSolver.readBoard(puzzle);
+    return sudokuSolver.inferAC3Guessing();
+}
+
+// Solves every puzzle for a number of rounds on one instance of a backend, resetting it between rounds
+static std::size_t solveReused(SolverBackend& solver, const std::vector<Board>& boards, int rounds, std::size_t& solves){
+    std::size_t solved = 0;
+    for(int round=0; round<rounds; ++round){
+        solver.reset();
+        for(const Board& board : boards){
+            solved += solver.solve(board) ? 1 : 0;
+            ++solves;
+        }
+    }
+    return solved;
+}
+
+// Prints one line of results; true if nothing was allocated and every puzzle was solved
+static bool report(const std::string& name, std::size_t solves, std::size_t solved, std::size_t allocations){
+    std::cout << name << ": solves: " << solves << ", solved: " << solved
+              << ", heap allocations: " << allocations
+              << " (" << double(allocations) / solves << " per solve)" << std::endl;
+    return allocations == 0 && solved == solves;
+}
+
+int main() {
+    const std::vector<std::string> puzzles = {
+        "010420005002071039000000040207100006000040000600007403070000000120730500300082070",
+        "000700003096000000200850000170204036060070040082603510000017008000000250900002000",
+        "800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+        "000000010400000000020000000000050407008000300001090000300400200050100000000806000",
+    };
+    const int rounds = 20;
+    std::vector<Board> boards(puzzles.size());
+    for(std::size_t puzzle=0; puzzle<puzzles.size(); ++puzzle){
+        for(int cell=0; cell<81; ++cell){
+            boards[puzzle][cell] = static_cast<std::uint8_t>(puzzles[puzzle][cell] - '0');
+        }
+    }
+    // Backends are built before counting; only the solves themselves are measured
+    const std::unique_ptr<SolverBackend> ac3Solver = makeSolverBackend("ac3");
+    const std::unique_ptr<SolverBackend> dlxSolver = makeSolverBackend("dlx");
+    const std::unique_ptr<SolverBackend> variantSolver = makeSolverBackend("variant");
+
+    // Warm up once so that lazily initialized library state is not counted
+    std::size_t warmUp = 0;
+    for(const std::string& puzzle : puzzles){
+        solvePuzzle(puzzle);
+    }
+    solveReused(*ac3Solver, boards, 1, warmUp);
+    solveReused(*dlxSolver, boards, 1, warmUp);
+    solveReused(*variantSolver, boards, 1, warmUp);
+
+    std::size_t solved = 0;
+    std::size_t solves = 0;
+    std::size_t allocationsBefore = allocationCount;
+    for(int round=0; round<rounds; ++round){
+        for(const std::string& puzzle : puzzles){
+            solved += solvePuzzle(puzzle) ? 1 : 0;
+            ++solves;
+        }
+    }
+    bool clean = report("fresh ac3 solvers", solves, solved, allocationCount - allocationsBefore);
+
+    const std::vector<std::pair<std::string, SolverBackend*>> reused = {{"reused ac3 solver", ac3Solver.get()},
+                                                                        {"reused dlx solver", dlxSolver.get()},
+                                                                        {"reused variant solver", variantSolver.get()}};
+    for(const std::pair<std::string, SolverBackend*>& backend : reused){
+        solves = 0;
+        allocationsBefore = allocationCount;
+        solved = solveReused(*backend.second, boards, rounds, solves);
+        clean = report(backend.first, solves, solved, allocationCount - allocationsBefore) && clean;
+    }
+    return clean ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+#include "sudokuSolver.hpp"
+#include "dlxSolver.hpp"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Failures found so far; each is reported once on stderr
+static std::size_t failures = 0;
+
+static void fail(const std::string& where, const std::string& reason){
+    ++failures;
+    std::cerr << where << ": " << reason << "\n";
+}
+
+// Reads one 81-character puzzle per line.
+static bool readPuzzles(const std::string& path, std::vector<std::string>& puzzles){
+    std::ifstream file(path);
+    std::string line;
+    while(std::getline(file, line)){
+        if(line.size() >= 81){
+            puzzles.push_back(line.substr(0, 81));
+        }
+    }
+    return file.eof() && !puzzles.empty();
+}
+
+/**
+ * Builds the board a session should hold after the given placements from scratch, on a fresh
+ * solver: the reference that unplace must restore exactly.
+ */
+static CellDomains replayedBoard(SudokuSolver& reference, const std::string& puzzle,
+                                 const std::vector<std::pair<int, int>>& placed){
+    reference.readBoard(puzzle);
+    reference.startHints();
+    for(const std::pair<int, int>& placement : placed){
+        reference.place(placement.first, placement.second);
+    }
+    return reference.getCellValues();
+}
+
+/**
+ * Plays one game against the solution found by the Dancing Links solver, placing a wrong value
+ * now and then. Every hint must name a wrong placement first (mistake), and otherwise give the
+ * solution's value, with a naked single only where a single candidate is left. Taking back the
+ * last placement must restore the board exactly, and taking back an older one must leave the
+ * board a fresh session reaches with the remaining placements.
+ */
+static void playGame(SudokuSolver& solver, SudokuSolver& reference, DlxSolver& dlxSolver, std::size_t index,
+                     const std::string& puzzle, std::mt19937& random, std::vector<std::size_t>& techniques){
+    const std::string game = "puzzle " + std::to_string(index);
+    dlxSolver.readBoard(puzzle);
+    if(!dlxSolver.solve()){
+        fail(game, "the puzzle has no solution");
+        return;
+    }
+    const CellDomains solution = dlxSolver.getCellValues();
+    solver.readBoard(puzzle);
+    if(!solver.startHints()){
+        fail(game, "startHints found no solution");
+        return;
+    }
+    std::vector<std::pair<int, int>> placed;
+    std::vector<int> wrong;
+    for(int move=0; move<200; ++move){
+        // Now and then a wrong value in a random open cell; place refuses it if it empties a peer
+        if(random() % 8 == 0){
+            const int cell = static_cast<int>(random() % 81);
+            const CandidateMask others = solver.getCellValues()[cell] & ~solution[cell];
+            if(countCandidates(solver.getCellValues()[cell]) > 1 && others != 0){
+                const CellDomains before = solver.getCellValues();
+                const int value = firstCandidate(others);
+                if(solver.place(cell, value)){
+                    // Taking it straight back must restore the board, then it is placed again
+                    if(!solver.unplace(cell) || solver.getCellValues() != before){
+                        fail(game, "unplace did not restore the board");
+                        return;
+                    }
+                    solver.place(cell, value);
+                    placed.push_back({cell, value});
+                    wrong.push_back(cell);
+                } else if(solver.getCellValues() != before){
+                    fail(game, "a refused placement changed the board");
+                    return;
+                }
+            }
+        }
+
+        const SudokuHint hint = solver.nextHint();
+        if(hint.technique < 0 || hint.technique >= hintTechniqueCount){
+            fail(game, "hint with an unknown technique");
+            return;
+        }
+        ++techniques[hint.technique];
+        if(hint.technique == noHint){
+            if(!wrong.empty() || solver.getCellValues() != solution){
+                fail(game, "no hint before the puzzle is solved");
+            }
+            return;
+        }
+        if(hint.value != firstCandidate(solution[hint.cell])){
+            fail(game, std::string("wrong value in a ") + hintTechniqueName(hint.technique) + " hint");
+            return;
+        }
+        if(hint.technique == mistakeHint){
+            bool isWrong = false;
+            for(std::size_t position=0; position<wrong.size(); ++position){
+                if(wrong[position] == hint.cell){
+                    wrong.erase(wrong.begin() + position);
+                    isWrong = true;
+                    break;
+                }
+            }
+            if(!isWrong){
+                fail(game, "mistake hint on a correct placement");
+                return;
+            }
+            // Taking back an older placement replays the later ones
+            for(std::size_t position=0; position<placed.size(); ++position){
+                if(placed[position].first == hint.cell){
+                    placed.erase(placed.begin() + position);
+                    break;
+                }
+            }
+            if(!solver.unplace(hint.cell) || solver.getCellValues() != replayedBoard(reference, puzzle, placed)){
+                fail(game, "unplace of an older placement did not match a replay");
+                return;
+            }
+            continue;
+        }
+        if(!wrong.empty()){
+            fail(game, "a wrong placement was not reported first");
+            return;
+        }
+        if(hint.technique == nakedSingleHint && countCandidates(solver.getCellValues()[hint.cell]) != 1){
+            fail(game, "naked single on a cell with several candidates");
+            return;
+        }
+        if(!solver.place(hint.cell, hint.value)){
+            fail(game, "the hinted value could not be placed");
+            return;
+        }
+        placed.push_back({hint.cell, hint.value});
+    }
+    fail(game, "the game did not end");
+}
+
+// Clues that clash (two 5s in the first row) must leave the board as read and refuse everything.
+static void checkClashingClues(SudokuSolver& solver){
+    const std::string puzzle = "5...5...." + std::string(72, '.');
+    solver.readBoard(puzzle);
+    const CellDomains asRead = solver.getCellValues();
+    if(solver.startHints()){
+        fail("clashing clues", "startHints found a solution");
+    }
+    if(solver.getCellValues() != asRead){
+        fail("clashing clues", "the board was changed");
+    }
+    for(int cell=0; cell<81; ++cell){
+        for(int value=1; value<=9; ++value){
+            if(solver.place(cell, value)){
+                fail("clashing clues", "a placement was accepted");
+                return;
+            }
+        }
+    }
+    if(solver.nextHint().technique != noHint){
+        fail("clashing clues", "a hint was given");
+    }
+}
+
+/**
+ * Checks the hint session of the AC-3 solver by playing a game on every puzzle of the given
+ * corpora, as described at playGame, and exits non-zero on any failure.
+ */
+int main(int argc, char* argv[]) {
+    if(argc < 2){
+        std::cerr << "Usage: " << argv[0] << " <corpus file>...\n";
+        return 1;
+    }
+    std::unique_ptr<SudokuSolver> solver(new SudokuSolver());
+    std::unique_ptr<SudokuSolver> reference(new SudokuSolver());
+    std::unique_ptr<DlxSolver> dlxSolver(new DlxSolver());
+    std::mt19937 random(1);
+    std::vector<std::size_t> techniques(hintTechniqueCount, 0);
+    std::size_t games = 0;
+    for(int corpus=1; corpus<argc; ++corpus){
+        std::vector<std::string> puzzles;
+        if(!readPuzzles(argv[corpus], puzzles)){
+            std::cerr << "Failed to read " << argv[corpus] << "\n";
+            return 1;
+        }
+        for(const std::string& puzzle : puzzles){
+            playGame(*solver, *reference, *dlxSolver, games++, puzzle, random, techniques);
+        }
+    }
+    checkClashingClues(*solver);
+
+    std::cout << "games: " << games << ", failures: " << failures << "\nhints:";
+    for(int technique=0; technique<hintTechniqueCount; ++technique){
+        std::cout << (technique == 0 ? " " : ", ") << hintTechniqueName(static_cast<HintTechnique>(technique))
+                  << ": " << techniques[technique];
+    }
+    std::cout << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include "eliminationKernel.hpp"
+#include "sudokuSolver.hpp"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+// Boards checked per kind
+static const int boardCount = 100000;
+
+// Mismatches found so far, the first few of which are printed on stderr, and boards that contradict themselves
+static std::size_t mismatches = 0;
+static std::size_t contradictions = 0;
+
+static void mismatch(const std::string& kind, int board, const std::string& reason){
+    if(++mismatches <= 10){
+        std::cerr << kind << " board " << board << ": " << reason << "\n";
+    }
+}
+
+static bool hasEmptyCell(const CellDomains& cells){
+    for(CandidateMask mask : cells){
+        if(mask == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Runs every kernel this CPU supports on a copy of the board and compares them with the scalar
+ * one: the contradiction flags must agree, and so must the masks on a consistent board (after a
+ * contradiction the board may be left partly narrowed, differently per kernel).
+ *
+ * @return Whether the scalar kernel found the board consistent; its result is left in cells.
+ */
+static bool compareKernels(const std::string& kind, int board, CellDomains& cells){
+    const CellDomains original = cells;
+    const bool consistent = eliminateSolvedScalar(cells);
+#if defined(__x86_64__) || defined(__i386__)
+    if(__builtin_cpu_supports("avx2")){
+        CellDomains vector = original;
+        if(eliminateSolvedAvx2(vector) != consistent){
+            mismatch(kind, board, "avx2 and scalar disagree on the contradiction");
+        } else if(consistent && vector != cells){
+            mismatch(kind, board, "avx2 and scalar masks differ");
+        }
+    }
+#endif
+    contradictions += consistent ? 0 : 1;
+    return consistent;
+}
+
+// A solution grid with its values relabelled at random, so that every call gives another one.
+static Board randomSolution(const CellDomains& grid, std::mt19937& random){
+    std::array<std::uint8_t, 9> values = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::shuffle(values.begin(), values.end(), random);
+    Board solution;
+    for(int cell=0; cell<81; ++cell){
+        solution[cell] = values[firstCandidate(grid[cell]) - 1];
+    }
+    return solution;
+}
+
+/**
+ * Clues taken from a random solution, one in four boards with one random clue more that may clash,
+ * read into the AC-3 solver. The kernels must agree with inferAC3 run to completion: a contradiction
+ * there leaves a cell without candidates, and on a consistent board the masks are the same.
+ */
+static void checkClueBoards(SudokuSolver& solver, const CellDomains& grid, std::mt19937& random){
+    for(int index=0; index<boardCount; ++index){
+        const Board solution = randomSolution(grid, random);
+        Board board{};
+        const int clues = static_cast<int>(random() % 40);
+        for(int clue=0; clue<clues; ++clue){
+            const int cell = static_cast<int>(random() % 81);
+            board[cell] = solution[cell];
+        }
+        if(random() % 4 == 0){
+            board[random() % 81] = static_cast<std::uint8_t>(1 + random() % 9);
+        }
+        solver.readBoard(board);
+        CellDomains cells = solver.getCellValues();
+        const bool consistent = compareKernels("clue", index, cells);
+        solver.inferAC3();
+        const CellDomains& inferred = solver.getCellValues();
+        if(hasEmptyCell(inferred) == consistent){
+            mismatch("clue", index, "inferAC3 and the kernels disagree on the contradiction");
+        } else if(consistent && inferred != cells){
+            mismatch("clue", index, "inferAC3 and kernel masks differ");
+        }
+    }
+}
+
+/**
+ * Partly narrowed domains around a random solution: cells are solved or keep their solution value
+ * among random others. One in four boards has one cell that loses it, which may contradict the board.
+ */
+static void checkNarrowedBoards(const CellDomains& grid, std::mt19937& random){
+    for(int index=0; index<boardCount; ++index){
+        const Board solution = randomSolution(grid, random);
+        CellDomains cells;
+        for(int cell=0; cell<81; ++cell){
+            const CandidateMask noise = static_cast<CandidateMask>(random() & allCandidates);
+            cells[cell] = candidateBit(solution[cell]) | (random() % 3 == 0 ? 0 : noise);
+        }
+        if(random() % 4 == 0){
+            const int cell = static_cast<int>(random() % 81);
+            cells[cell] = static_cast<CandidateMask>(random() & allCandidates);
+        }
+        compareKernels("narrowed", index, cells);
+    }
+}
+
+/**
+ * Checks the whole-grid elimination kernels against each other and against inferAC3 on random
+ * partial boards, whichever kernel the dispatch would pick, and exits non-zero on any mismatch.
+ */
+int main() {
+#if defined(__x86_64__) || defined(__i386__)
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#else
+    const bool avx2 = false;
+#endif
+    std::unique_ptr<SudokuSolver> solver(new SudokuSolver());
+    solver->solve(Board{});
+    const CellDomains grid = solver->getCellValues();
+    std::mt19937 random(1);
+    checkClueBoards(*solver, grid, random);
+    checkNarrowedBoards(grid, random);
+    std::cout << "dispatched kernel: " << eliminationKernelName() << ", compared: scalar"
+              << (avx2 ? ", avx2" : " (no avx2 on this CPU)") << ", inferAC3\n"
+              << "boards: " << 2 * boardCount << ", contradictions: " << contradictions << ", mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+#include "solverBackend.hpp"
+#include "sudokuSolver.hpp"
+#include "sudokuTopology.hpp"
+#include "eliminationKernel.hpp"
+#include "solveCache.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Results of solving one corpus for all rounds
+struct CorpusResult {
+    std::string name;
+    std::size_t puzzles = 0;
+    std::size_t solved = 0;
+    double seconds = 0.0;
+    // Solve time of every puzzle in every round, in microseconds
+    std::vector<double> latencies;
+    // Totals of one round
+    SearchStats stats;
+    // Totals of one round of the detailed AC-3 statistics, when the build collects them
+    bool hasSolverStats = false;
+    SolverStats solverStats;
+    // Lookups of the solve cache over all rounds, when one is used
+    bool hasCache = false;
+    std::uint64_t cacheHits = 0;
+    std::uint64_t cacheMisses = 0;
+};
+
+// Adds the detailed statistics of one solve to the totals.
+static void addSolverStats(SolverStats& total, const SolverStats& stats){
+    total.arcsProcessed += stats.arcsProcessed;
+    total.kernelRuns += stats.kernelRuns;
+    total.valuesRemoved += stats.valuesRemoved;
+    total.hiddenSingles += stats.hiddenSingles;
+    total.rollbacks += stats.rollbacks;
+    total.maxDepth = std::max(total.maxDepth, stats.maxDepth);
+    for(int phase=0; phase<solverPhaseCount; ++phase){
+        total.phaseSeconds[phase] += stats.phaseSeconds[phase];
+    }
+}
+
+// Reads one puzzle per line, skipping empty lines and a trailing '\r'.
+static bool readCorpus(const std::string& path, std::vector<std::string>& puzzles){
+    std::ifstream file(path);
+    if(!file.is_open()){
+        return false;
+    }
+    std::string line;
+    while(std::getline(file, line)){
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        if(line.size() >= 81){
+            puzzles.push_back(line.substr(0, 81));
+        }
+    }
+    return true;
+}
+
+// Checks that the board is a complete, valid grid that keeps the givens of the puzzle.
+static bool isValidSolution(const std::string& puzzle, const CellDomains& cells){
+    for(int cell=0; cell<81; ++cell){
+        if(countCandidates(cells[cell]) != 1){
+            return false;
+        }
+        const int given = puzzle[cell] - '0';
+        if(given >= 1 && given <= 9 && cells[cell] != candidateBit(given)){
+            return false;
+        }
+    }
+    for(const std::array<CellId, 9>& unit : sudokuTopology.units){
+        CandidateMask seen = 0;
+        for(CellId cell : unit){
+            seen |= cells[cell];
+        }
+        if(seen != allCandidates){
+            return false;
+        }
+    }
+    return true;
+}
+
+// The value at the given fraction of the sorted latencies.
+static double percentile(const std::vector<double>& sorted, double fraction){
+    if(sorted.empty()){
+        return 0.0;
+    }
+    std::size_t rank = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+/**
+ * Solves every puzzle of a corpus the given number of times, timing each solve on its own.
+ *
+ * @param solver The backend to measure.
+ * @param name Name of the corpus in the report.
+ * @param puzzles The puzzles of the corpus.
+ * @param rounds How many times the corpus is solved.
+ * @param cacheSize Capacity of a solve cache put in front of the AC-3 solver for this corpus, 0 for none.
+ * @return The measurements.
+ */
+static CorpusResult runCorpus(SolverBackend& solver, const std::string& name, const std::vector<std::string>& puzzles, int rounds,
+                              std::size_t cacheSize){
+    typedef std::chrono::steady_clock Clock;
+    CorpusResult result;
+    result.name = name;
+    result.puzzles = puzzles.size();
+    result.latencies.reserve(puzzles.size() * rounds);
+    SudokuSolver* ac3Solver = dynamic_cast<SudokuSolver*>(&solver);
+    result.hasSolverStats = solverStatsEnabled && ac3Solver != nullptr;
+    // A fresh cache per corpus, so only repeats within the corpus (and later rounds) are hits
+    std::unique_ptr<SolveCache> solveCache;
+    if(cacheSize != 0 && ac3Solver != nullptr){
+        solveCache.reset(new SolveCache(cacheSize));
+        ac3Solver->setSolveCache(solveCache.get());
+        result.hasCache = true;
+    }
+    for(int round=0; round<rounds; ++round){
+        for(const std::string& puzzle : puzzles){
+            const Clock::time_point start = Clock::now();
+            solver.readBoard(puzzle);
+            const bool solved = solver.solve();
+            const Clock::time_point end = Clock::now();
+            result.latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            result.seconds += std::chrono::duration<double>(end - start).count();
+            // Correctness and counters are taken from the first round; later rounds repeat them
+            if(round == 0){
+                const SearchStats& stats = solver.getSearchStats();
+                result.stats.nodes += stats.nodes;
+                result.stats.guesses += stats.guesses;
+                result.stats.propagations += stats.propagations;
+                result.solved += solved && isValidSolution(puzzle, solver.getCellValues()) ? 1 : 0;
+                if(result.hasSolverStats){
+                    addSolverStats(result.solverStats, ac3Solver->getSolverStats());
+                }
+            }
+        }
+    }
+    std::sort(result.latencies.begin(), result.latencies.end());
+    if(solveCache){
+        result.cacheHits = solveCache->getHits();
+        result.cacheMisses = solveCache->getMisses();
+        ac3Solver->setSolveCache(nullptr);
+    }
+    return result;
+}
+
+// Writes the results of one corpus as a JSON object.
+static void writeResult(std::ostream& out, const CorpusResult& result, int rounds){
+    const double solves = static_cast<double>(result.puzzles) * rounds;
+    out << "    {\n"
+        << "      \"name\": \"" << result.name << "\",\n"
+        << "      \"puzzles\": " << result.puzzles << ",\n"
+        << "      \"solved\": " << result.solved << ",\n"
+        << "      \"seconds\": " << result.seconds << ",\n"
+        << "      \"puzzlesPerSecond\": " << (result.seconds > 0.0 ? solves / result.seconds : 0.0) << ",\n"
+        << "      \"latencyMicros\": {\"p50\": " << percentile(result.latencies, 0.5)
+        << ", \"p99\": " << percentile(result.latencies, 0.99)
+        << ", \"max\": " << (result.latencies.empty() ? 0.0 : result.latencies.back()) << "},\n"
+        << "      \"nodes\": " << result.stats.nodes << ",\n"
+        << "      \"guesses\": " << result.stats.guesses << ",\n"
+        << "      \"propagationSteps\": " << result.stats.propagations;
+    if(result.hasCache){
+        out << ",\n"
+            << "      \"cache\": {\"hits\": " << result.cacheHits << ", \"misses\": " << result.cacheMisses << "}";
+    }
+    if(result.hasSolverStats){
+        const SolverStats& stats = result.solverStats;
+        out << ",\n"
+            << "      \"solverStats\": {\"arcsProcessed\": " << stats.arcsProcessed
+            << ", \"kernelRuns\": " << stats.kernelRuns
+            << ", \"valuesRemoved\": " << stats.valuesRemoved
+            << ", \"hiddenSingles\": " << stats.hiddenSingles
+            << ", \"rollbacks\": " << stats.rollbacks
+            << ", \"maxDepth\": " << stats.maxDepth << ",\n"
+            << "        \"phaseSeconds\": {\"initialPropagation\": " << stats.phaseSeconds[initialPropagationPhase]
+            << ", \"guessPropagation\": " << stats.phaseSeconds[guessPropagationPhase]
+            << ", \"guessSelection\": " << stats.phaseSeconds[guessSelectionPhase]
+            << ", \"rollback\": " << stats.phaseSeconds[rollbackPhase] << "}}";
+    }
+    out << "\n"
+        << "    }";
+}
+
+// Finds the enum value with the given name among count names.
+template<typename Enum>
+static bool parseName(const std::string& name, const char* (*nameOf)(Enum), int count, Enum& value){
+    for(int candidate=0; candidate<count; ++candidate){
+        if(name == nameOf(static_cast<Enum>(candidate))){
+            value = static_cast<Enum>(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Name of a corpus: its file name without directory and extension.
+static std::string corpusName(const std::string& path){
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
+
+static int printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--engine ac3|dlx|variant] [--rounds N] [--cache N] [--cells mrv|degree]"
+              << " [--values ascending|lcv|hidden] <corpus file>...\n";
+    return 1;
+}
+
+/**
+ * Benchmarks a solver backend over puzzle corpora and prints the results as JSON: throughput,
+ * latency percentiles and the search counters of every corpus. Nodes, guesses and propagation
+ * steps are the totals of one pass over the corpus, as are the detailed AC-3 statistics that a
+ * SUDOKU_STATS build adds. --cells and --values choose the branching heuristics of the AC-3
+ * solver, to compare them on the same corpora.
+ */
+int main(int argc, char* argv[]) {
+    std::string engine = "ac3";
+    int rounds = 3;
+    std::size_t cacheSize = 0;
+    BranchingStrategy branching;
+    std::vector<std::string> corpora;
+    for(int i=1; i<argc; ++i){
+        std::string option = argv[i];
+        if(option == "--engine" && i + 1 < argc){
+            engine = argv[++i];
+        } else if(option == "--rounds" && i + 1 < argc){
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else if(option == "--cache" && i + 1 < argc){
+            cacheSize = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if(option == "--cells" && i + 1 < argc){
+            if(!parseName(argv[++i], cellSelectionName, cellSelectionCount, branching.cellSelection)){
+                return printUsage(argv[0]);
+            }
+        } else if(option == "--values" && i + 1 < argc){
+            if(!parseName(argv[++i], valueOrderingName, valueOrderingCount, branching.valueOrdering)){
+                return printUsage(argv[0]);
+            }
+        } else if(!option.empty() && option[0] != '-'){
+            corpora.push_back(option);
+        } else {
+            return printUsage(argv[0]);
+        }
+    }
+    std::unique_ptr<SolverBackend> solver = makeSolverBackend(engine);
+    if(!solver || corpora.empty()){
+        return printUsage(argv[0]);
+    }
+    SudokuSolver* ac3Solver = dynamic_cast<SudokuSolver*>(solver.get());
+    if(ac3Solver != nullptr){
+        ac3Solver->setBranching(branching);
+    }
+
+    std::vector<CorpusResult> results;
+    for(const std::string& path : corpora){
+        std::vector<std::string> puzzles;
+        if(!readCorpus(path, puzzles)){
+            std::cerr << "Failed to open " << path << "\n";
+            return 1;
+        }
+        results.push_back(runCorpus(*solver, corpusName(path), puzzles, rounds, cacheSize));
+    }
+
+    bool allSolved = true;
+    std::cout << "{\n"
+              << "  \"engine\": \"" << engine << "\",\n"
+              << "  \"eliminationKernel\": \"" << eliminationKernelName() << "\",\n";
+    if(ac3Solver != nullptr){
+        std::cout << "  \"branching\": {\"cells\": \"" << cellSelectionName(branching.cellSelection)
+                  << "\", \"values\": \"" << valueOrderingName(branching.valueOrdering) << "\"},\n";
+    }
+    std::cout << "  \"rounds\": " << rounds << ",\n"
+              << "  \"corpora\": [\n";
+    for(std::size_t i=0; i<results.size(); ++i){
+        writeResult(std::cout, results[i], rounds);
+        std::cout << (i + 1 < results.size() ? ",\n" : "\n");
+        allSolved = allSolved && results[i].solved == results[i].puzzles;
+    }
+    std::cout << "  ]\n}" << std::endl;
+    return allSolved ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#ifndef BATCH_SOLVER_HPP
+#define BATCH_SOLVER_HPP
+
+#include "solverBackend.hpp"
+#include "boardWriter.hpp"
+#include "solveCache.hpp"
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Totals reported after solving a batch of puzzles
+struct BatchSummary {
+    std::size_t puzzles = 0;
+    std::size_t solved = 0;
+    std::size_t malformed = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * Solves many puzzles across all cores. Puzzles are split into small index ranges that are dealt
+ * out to per-thread deques; a worker takes ranges from the back of its own deque and, once that is
+ * empty, steals from the front of the others. Every worker keeps a single solver instance and writes
+ * each solution straight into the slot of its puzzle, so the output keeps the input order.
+ */
+class BatchSolver {
+
+private:
+    // A worker's share of the puzzles, as half-open index ranges
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::pair<std::size_t, std::size_t>> ranges;
+    };
+
+    unsigned threadCount;
+    // Name of the solver backend every worker creates
+    std::string engine;
+    // Number of puzzles handed out at a time
+    std::size_t chunkSize;
+    // Solution cache shared by the workers of the AC-3 engine, if any
+    SolveCache* solveCache;
+    // Number of puzzles solveFile reads, solves and writes at a time
+    static const std::size_t streamBatchSize = 65536;
+
+    // Take the next range for a worker, stealing from other workers when its own deque is empty
+    static bool takeWork(std::vector<WorkQueue>& queues, unsigned worker, std::pair<std::size_t, std::size_t>& range);
+    // Solve puzzles until no work is left anywhere
+    static void runWorker(std::vector<WorkQueue>& queues, unsigned worker, const std::string& engine, SolveCache* solveCache,
+                          const std::vector<Board>& puzzles, std::vector<Board>& solutions, std::size_t& solved);
+
+public:
+    // A thread count of 0 uses every available core; engine names a backend known to makeSolverBackend
+    explicit BatchSolver(unsigned threadCount = 0, const std::string& engine = "ac3", std::size_t chunkSize = 16);
+    // Let every AC-3 worker consult the cache (nullptr for none); it must outlive the solving
+    void setSolveCache(SolveCache* cache);
+    // Solve every puzzle; solution i is written to solutions[i], an empty board if puzzle i has no solution
+    BatchSummary solve(const std::vector<Board>& puzzles, std::vector<Board>& solutions);
+    // Stream a file of puzzles ("-" for stdin), text or packed, writing the solutions to outputPath
+    // ("-" for stdout) in input order and the given format
+    bool solveFile(const std::string& inputPath, const std::string& outputPath, BatchSummary& summary,
+                   BoardWriter::Format format = BoardWriter::textFormat);
+    unsigned getThreadCount() const;
+};
+
+#endif
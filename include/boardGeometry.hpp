@@ -0,0 +1,91 @@
+#ifndef BOARD_GEOMETRY_HPP
+#define BOARD_GEOMETRY_HPP
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Compile-time geometry of a board with blocks of Order x Order cells: a 4x4 board has order 2,
+ * the classic 9x9 board order 3, 16x16 order 4, 25x25 order 5 and 36x36 order 6. Every size and
+ * storage type the solver needs follows from the order, so each instantiation is specialized for
+ * its board with no runtime dimensions.
+ */
+template<int Order>
+struct BoardGeometry {
+    static_assert(Order >= 2 && Order <= 6, "supported box orders are 2 to 6");
+
+    static constexpr int order = Order;
+    // Number of values, and of cells in every row, column and block
+    static constexpr int size = Order * Order;
+    static constexpr int cellCount = size * size;
+    // Rows, then columns, then blocks
+    static constexpr int unitCount = 3 * size;
+    // Distinct cells sharing a unit with a cell: its row and column, plus the rest of its block
+    static constexpr int peerCount = 3 * (size - 1) - 2 * (Order - 1);
+    static constexpr int arcCount = cellCount * peerCount;
+
+    // Candidate domain of a cell: bit (value - 1) is set while value is still possible.
+    // The narrowest of 16, 32 or 64 bits that holds every value.
+    typedef std::conditional_t<(size <= 16), std::uint16_t,
+            std::conditional_t<(size <= 32), std::uint32_t, std::uint64_t>> Mask;
+    // Position of a cell on the flat board
+    typedef std::conditional_t<(cellCount <= 256), std::uint8_t, std::uint16_t> CellId;
+    // Position of an arc in the topology tables
+    typedef std::conditional_t<(arcCount <= 65536), std::uint16_t, std::uint32_t> ArcId;
+    // Candidate masks of the whole board, stored row by row
+    typedef std::array<Mask, cellCount> Domains;
+    // A puzzle in compact form: the value of every cell row by row, 0 for an empty cell
+    typedef std::array<std::uint8_t, cellCount> Board;
+
+    // Domain of an empty cell
+    static constexpr Mask allCandidates = static_cast<Mask>((Mask(1) << size) - 1);
+
+    // Mask holding the single candidate value
+    static constexpr Mask candidateBit(int value){
+        return static_cast<Mask>(Mask(1) << (value - 1));
+    }
+};
+
+// Number of candidates left in a domain of any width
+template<typename Mask>
+inline int countCandidates(Mask mask){
+    return sizeof(Mask) <= sizeof(unsigned) ? __builtin_popcount(mask) : __builtin_popcountll(mask);
+}
+
+// Smallest candidate value of a non-empty domain (the value itself once the cell is solved)
+template<typename Mask>
+inline int firstCandidate(Mask mask){
+    return (sizeof(Mask) <= sizeof(unsigned) ? __builtin_ctz(mask) : __builtin_ctzll(mask)) + 1;
+}
+
+/**
+ * Character of a value in puzzle files and output: 1-9, then A-Z for 10 to 35 and a-z beyond that.
+ *
+ * @param value The value, from 1 to the board size.
+ * @return The character standing for it.
+ */
+inline char valueSymbol(int value){
+    return static_cast<char>(value <= 9 ? '0' + value : (value <= 35 ? 'A' + value - 10 : 'a' + value - 36));
+}
+
+/**
+ * Reads a value character of a board with the given number of values.
+ *
+ * @param symbol The character to read.
+ * @param size The largest value on the board.
+ * @return The value, or 0 if the character does not stand for a value (an empty cell).
+ */
+inline int symbolValue(char symbol, int size){
+    int value = 0;
+    if(symbol >= '1' && symbol <= '9'){
+        value = symbol - '0';
+    } else if(symbol >= 'A' && symbol <= 'Z'){
+        value = symbol - 'A' + 10;
+    } else if(symbol >= 'a' && symbol <= 'z'){
+        value = symbol - 'a' + 36;
+    }
+    return value <= size ? value : 0;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef BOARD_WRITER_HPP
+#define BOARD_WRITER_HPP
+
+#include "solverBackend.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Writes 9x9 boards to a file or stdout through one large buffer that goes straight to write(2),
+ * without iostreams. Boards are written as text lines of 81 characters ('.' for empty cells) or as
+ * packed records behind a packed header (see packedBoard.hpp), which PuzzleReader reads back.
+ */
+class BoardWriter {
+
+public:
+    enum Format {
+        textFormat,
+        packedFormat
+    };
+
+private:
+    // Bytes collected before they are written out
+    static const std::size_t bufferSize = 1 << 20;
+
+    int descriptor;
+    Format format;
+    std::vector<char> buffer;
+    std::size_t used;
+    // A write failed; everything after it is dropped
+    bool failed;
+
+    // Write out the buffered bytes
+    void flush();
+    // Make room for at least count more bytes
+    void reserve(std::size_t count);
+
+public:
+    BoardWriter();
+    ~BoardWriter();
+    BoardWriter(const BoardWriter&) = delete;
+    BoardWriter& operator=(const BoardWriter&) = delete;
+
+    // Create or truncate a file, or use stdout for "-"; false if it cannot be opened
+    bool open(const std::string& path, Format format);
+    // Append boards in the chosen format
+    void write(const Board& board);
+    void write(const Board* boards, std::size_t count);
+    // Write out everything and close the output; false if any write failed
+    bool close();
+};
+
+#endif
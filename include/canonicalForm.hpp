@@ -0,0 +1,42 @@
+#ifndef CANONICAL_FORM_HPP
+#define CANONICAL_FORM_HPP
+
+#include "solverBackend.hpp"
+#include <array>
+#include <cstdint>
+
+/**
+ * A validity-preserving symmetry of the 9x9 board: an optional transposition, a permutation of
+ * the rows that keeps bands together, a permutation of the columns that keeps stacks together
+ * and a relabeling of the values. Cell (row, col) of the transformed board comes from cell
+ * (rows[row], cols[col]) of the original board, read transposed if transposed is set, with its
+ * value v replaced by labels[v].
+ */
+struct BoardSymmetry {
+    bool transposed;
+    std::array<std::uint8_t, 9> rows;
+    std::array<std::uint8_t, 9> cols;
+    // labels[0] is 0, so empty cells stay empty
+    std::array<std::uint8_t, 10> labels;
+
+    // Transform a board of the original orientation
+    void apply(const Board& board, Board& transformed) const;
+    // Map a transformed board back to the original orientation
+    void invert(const Board& transformed, Board& board) const;
+};
+
+/**
+ * Finds the canonical form of a puzzle: the smallest board, row by row, that any symmetry turns it
+ * into, with the values relabeled in order of their first appearance. Boards that are symmetric
+ * variants of each other share their canonical form. The clue pattern is minimized first, which
+ * fixes the symmetry for almost every puzzle; ties are broken on the relabeled values.
+ *
+ * @param board The puzzle, 0 for empty cells.
+ * @param canonical Receives the canonical form.
+ * @param symmetry Receives a symmetry that turns the puzzle into its canonical form.
+ * @return false if the clue pattern has too many symmetries of its own to search them all cheaply
+ *         (nearly empty boards), in which case nothing is written.
+ */
+bool canonicalizeBoard(const Board& board, Board& canonical, BoardSymmetry& symmetry);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef DLX_SOLVER_HPP
+#define DLX_SOLVER_HPP
+
+#include "solverBackend.hpp"
+#include <array>
+#include <string>
+
+/**
+ * Exact cover solver using Knuth's Dancing Links (Algorithm X). Sudoku is encoded as 324 constraint
+ * columns (each cell filled once, each value once per row, column and block) and 729 candidate rows,
+ * one per (cell, value) pair, each covering exactly four columns.
+ *
+ * The node pool is built once by the constructor. Covering and uncovering restore the links exactly,
+ * so after every solve the structure is unwound back to its pristine state and reused for the next puzzle.
+ */
+class DlxSolver : public SolverBackend {
+
+private:
+    static const int columnCount = 324;
+    static const int rowCount = 729;
+    // Node 0 is the root, nodes 1-324 are the column headers, then 4 nodes per candidate row
+    static const int root = 0;
+    static const int nodeCount = 1 + columnCount + rowCount * 4;
+
+    // Four-way links and the owning column of every node
+    std::array<short, nodeCount> left;
+    std::array<short, nodeCount> right;
+    std::array<short, nodeCount> up;
+    std::array<short, nodeCount> down;
+    std::array<short, nodeCount> column;
+    // Candidate row (cell * 9 + value - 1) of every row node
+    std::array<short, nodeCount> candidate;
+    // Number of rows still linked into each column
+    std::array<short, columnCount + 1> columnSize;
+    std::array<bool, columnCount + 1> columnCovered;
+
+    // Chosen row node per search level; levels never exceed the 81 cells
+    std::array<short, 81> searchStack;
+    // Row nodes of the givens, selected before the search starts
+    std::array<short, 81> givenRows;
+    int givenCount;
+    // Values of the puzzle (0 for empty) and the resulting board
+    std::array<std::uint8_t, 81> givens;
+    CellDomains cellValues;
+    // Counters of the last search
+    SearchStats stats;
+
+    void cover(int columnNode);
+    void uncover(int columnNode);
+    // Cover all columns of a row, or undo that
+    void selectRow(int rowNode);
+    void deselectRow(int rowNode);
+    // The uncovered column with the fewest rows
+    int chooseColumn() const;
+    // Record the rows on the search stack as the solution
+    void recordSolution(int depth);
+
+public:
+    DlxSolver();
+    using SolverBackend::readBoard;
+    void readBoard(const Board& board) override;
+    // Clear the puzzle and the counters; the matrix is already pristine between solves
+    void reset() override;
+    using SolverBackend::solve;
+    bool solve() override;
+    std::size_t countSolutions(std::size_t limit, std::vector<CellDomains>* solutions = nullptr) override;
+    const CellDomains& getCellValues() const override;
+    const SearchStats& getSearchStats() const override;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef ELIMINATION_KERNEL_HPP
+#define ELIMINATION_KERNEL_HPP
+
+#include "solverBackend.hpp"
+
+/**
+ * Whole-grid elimination of solved cells. Instead of checking one arc at a time, every pass removes
+ * the values of all solved cells from all of their peers at once, and passes repeat until nothing
+ * changes. On a consistent board the result is the same as running inferAC3 to completion; after a
+ * contradiction the board may be left partly narrowed.
+ *
+ * @param cells The candidate masks of all cells, narrowed in place.
+ * @return false if a cell has no candidate left or two peers are solved with the same value, true otherwise.
+ */
+typedef bool (*EliminationKernel)(CellDomains& cells);
+
+// Portable version, one cell at a time
+bool eliminateSolvedScalar(CellDomains& cells);
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 version, one row of the board per 16-lane vector; only call it on CPUs that support AVX2
+bool eliminateSolvedAvx2(CellDomains& cells);
+#endif
+
+// The fastest kernel this CPU supports, detected on first use
+EliminationKernel eliminationKernel();
+// Name of that kernel, for reports
+const char* eliminationKernelName();
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef PACKED_BOARD_HPP
+#define PACKED_BOARD_HPP
+
+#include "solverBackend.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Packed binary form of 9x9 boards, for puzzle and solution files: an 8-byte header (packedMagic)
+ * followed by one fixed-size record per board. A record holds two cells per byte, the earlier cell
+ * of each pair in the low nibble, with 0 for an empty cell; the unused high nibble of the last byte
+ * is 0. At 41 bytes a board takes half the space of a text line and needs no parsing.
+ */
+
+// Bytes of one packed board
+const std::size_t packedBoardSize = (81 + 1) / 2;
+// Start of every packed file; the last character is the format version
+const std::size_t packedMagicSize = 8;
+const char packedMagic[packedMagicSize] = {'S', 'U', 'D', 'O', 'K', 'U', 'P', '1'};
+
+// Packs a board into packedBoardSize bytes.
+inline void packBoard(const Board& board, std::uint8_t* out){
+    for(std::size_t i=0; i+1<board.size(); i+=2){
+        out[i / 2] = static_cast<std::uint8_t>(board[i] | (board[i + 1] << 4));
+    }
+    out[packedBoardSize - 1] = board[board.size() - 1];
+}
+
+/**
+ * Unpacks a board from packedBoardSize bytes.
+ *
+ * @param in The packed record.
+ * @param board Receives the cell values.
+ * @return false if a cell holds a value above 9 or the padding nibble is set, true otherwise.
+ */
+inline bool unpackBoard(const std::uint8_t* in, Board& board){
+    std::uint8_t invalid = 0;
+    for(std::size_t i=0; i+1<board.size(); i+=2){
+        const std::uint8_t low = in[i / 2] & 0x0F;
+        const std::uint8_t high = in[i / 2] >> 4;
+        board[i] = low;
+        board[i + 1] = high;
+        // Adding 6 carries into bit 4 exactly for the nibbles 10 to 15
+        invalid |= ((low + 6) | (high + 6)) & 0x10;
+    }
+    const std::uint8_t last = in[packedBoardSize - 1];
+    board[board.size() - 1] = last & 0x0F;
+    return invalid == 0 && last <= 9;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PARALLEL_SEARCH_HPP
+#define PARALLEL_SEARCH_HPP
+
+#include "sudokuSolver.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * Solves a single hard puzzle on several threads, for boards of the given box order. One worker
+ * starts on the whole board; whenever another worker is idle and no shared work is queued, a busy
+ * worker hands over the untried values of its shallowest guess level (the top of its search tree).
+ * The first worker to find a solution cancels all the others.
+ */
+template<int Order>
+class BasicParallelSearch : public BasicSearchControl<Order> {
+
+private:
+    typedef typename BoardGeometry<Order>::Domains Domains;
+
+    unsigned threadCount;
+
+    std::mutex lock;
+    std::condition_variable workAvailable;
+    // Boards whose search has not been started by any worker yet
+    std::deque<Domains> tasks;
+    Domains solution;
+    // Read on every guess of every worker, so kept outside the lock
+    std::atomic<bool> found;
+    std::atomic<unsigned> idleWorkers;
+    std::atomic<std::size_t> queuedTasks;
+
+    // Take boards from the queue and search them until the puzzle is solved or no work is left
+    void runWorker();
+
+public:
+    // A thread count of 0 uses every available core
+    explicit BasicParallelSearch(unsigned threadCount = 0);
+    // Solve the board loaded in the solver; on success the solution is loaded back into it
+    bool solve(BasicSudokuSolver<Order>& sudokuSolver);
+    unsigned getThreadCount() const;
+
+    bool isCancelled() const override;
+    bool wantsWork() const override;
+    void shareWork(const Domains& cells) override;
+};
+
+typedef BasicParallelSearch<3> ParallelSearch;
+
+#endif
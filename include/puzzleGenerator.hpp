@@ -0,0 +1,91 @@
+#ifndef PUZZLE_GENERATOR_HPP
+#define PUZZLE_GENERATOR_HPP
+
+#include "sudokuSolver.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Difficulty grades, from the techniques a puzzle needs
+enum PuzzleDifficulty {
+    // Solved by removing the values of solved cells from their peers (naked singles, plain AC-3)
+    easyPuzzle,
+    // Also needs hidden singles, intersections or naked and hidden subsets (inferAC3Improved)
+    mediumPuzzle,
+    // Needs one or two guesses on top of full propagation
+    hardPuzzle,
+    // Needs more guesses than that
+    expertPuzzle,
+    puzzleDifficultyCount
+};
+
+// Name of a difficulty ("easy", "medium", "hard" or "expert")
+const char* difficultyName(PuzzleDifficulty difficulty);
+// Difficulty of a name; false if the name is unknown
+bool parseDifficulty(const std::string& name, PuzzleDifficulty& difficulty);
+
+// How a puzzle was graded, from the work the solver does on it
+struct PuzzleGrade {
+    PuzzleDifficulty difficulty = easyPuzzle;
+    // Cells still open after naked singles alone, and after full propagation (inferAC3Improved)
+    int openAfterElimination = 0;
+    int openAfterPropagation = 0;
+    // Search counters of solving the puzzle
+    std::uint64_t guesses = 0;
+    std::uint64_t nodes = 0;
+};
+
+// A generated puzzle with its unique solution and grade
+struct GeneratedPuzzle {
+    Board puzzle;
+    Board solution;
+    int clues = 0;
+    PuzzleGrade grade;
+};
+
+/**
+ * Generates graded 9x9 puzzles with a unique solution on several threads. A puzzle starts as a
+ * random full grid: the three diagonal blocks, which never constrain each other, are filled with
+ * random permutations and a randomized search completes the rest. Clues are then removed in random
+ * order as long as the solution stays unique, which leaves a minimal puzzle. Removing a clue keeps
+ * the solution unique exactly when no solution puts another value in its cell, so each check is a
+ * single search with that value excluded. These searches use a lightweight singles-only search on
+ * copied boards; the full solver grades the finished puzzle.
+ *
+ * Every puzzle comes from its own random stream, derived from the seed and its index, so the
+ * output for a seed does not depend on the number of threads.
+ */
+class PuzzleGenerator {
+
+private:
+    unsigned threadCount;
+    std::uint64_t seed;
+
+    // Generate puzzles until every index up to count is taken
+    void runWorker(std::atomic<std::size_t>& nextIndex, std::vector<GeneratedPuzzle>& puzzles,
+                   const PuzzleDifficulty* difficulty) const;
+    // Fill a random full grid
+    static void randomGrid(std::mt19937_64& random, Board& grid);
+    // Remove clues of the grid in random order while the solution stays unique, and optionally
+    // while naked singles alone still solve the puzzle
+    static void removeClues(std::mt19937_64& random, const Board& grid, bool nakedSinglesOnly, Board& puzzle);
+    // Generate one attempt at the puzzle of an index; later attempts use later random streams
+    GeneratedPuzzle generateAttempt(SudokuSolver& sudokuSolver, std::size_t index, std::uint64_t attempt,
+                                    bool nakedSinglesOnly) const;
+
+public:
+    // A thread count of 0 uses every available core
+    explicit PuzzleGenerator(unsigned threadCount = 0, std::uint64_t seed = 0);
+    // Generate count puzzles, all of the given difficulty if one is given
+    std::vector<GeneratedPuzzle> generate(std::size_t count, const PuzzleDifficulty* difficulty = nullptr) const;
+    // Generate the puzzle of one index with the given solver
+    GeneratedPuzzle generateOne(SudokuSolver& sudokuSolver, std::size_t index) const;
+    // Grade a puzzle with a unique solution; the search always branches on mrv with ascending values
+    static PuzzleGrade grade(SudokuSolver& sudokuSolver, const Board& puzzle);
+    unsigned getThreadCount() const;
+};
+
+#endif
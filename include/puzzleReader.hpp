@@ -0,0 +1,84 @@
+#ifndef PUZZLE_READER_HPP
+#define PUZZLE_READER_HPP
+
+#include "solverBackend.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Streams 9x9 puzzles, one 81-character line each, straight into compact boards. Regular files are
+ * memory-mapped and parsed in place; stdin and other streams are read in large blocks. No string
+ * is created per puzzle, so parsing keeps far ahead of the solvers even on multi-gigabyte inputs.
+ *
+ * Digits 1 to 9 are known values and '0', '.' or '*' empty cells. Empty lines are skipped and a
+ * trailing '\r' is ignored. Any other line is reported as malformed, with its position in the input.
+ *
+ * Input that starts with packedMagic is read as packed boards (see packedBoard.hpp) instead; its
+ * records take the place of lines, and a record with a cell above 9 or cut short is malformed.
+ */
+class PuzzleReader {
+
+public:
+    // Outcome of reading the next line
+    enum Status {
+        puzzleRead,
+        malformedLine,
+        endOfInput
+    };
+
+private:
+    // Size of the blocks read from streams that cannot be mapped
+    static const std::size_t blockSize = 1 << 20;
+
+    int descriptor;
+    // The whole mapped file, or nullptr when streaming
+    const char* mapped;
+    std::size_t mappedSize;
+    // Block buffer for streaming; the unparsed part is [bufferStart, bufferEnd)
+    std::vector<char> buffer;
+    std::size_t bufferStart;
+    std::size_t bufferEnd;
+    bool streamEnded;
+    // The rest of an overlong line is being skipped
+    bool discardingLine;
+    // Parse position in the mapping, and the input offset of the data at the parse position
+    std::size_t position;
+    std::uint64_t offset;
+    // Line number (from 1) and byte offset of the line returned last
+    std::uint64_t lineNumber;
+    std::uint64_t lineOffset;
+    // The input could not be read after it was opened
+    bool failed;
+    // The input holds packed records rather than text lines
+    bool packed;
+
+    // Find the next line; false once the input is exhausted
+    bool nextLine(const char*& line, std::size_t& length);
+    // Find the next packed record, shorter only at the end of the input; false once it is exhausted
+    bool nextRecord(const char*& record, std::size_t& length);
+    // Consume the packed header if the input starts with one
+    void detectPacked();
+    // Refill the block buffer, keeping the unparsed rest; false once the stream has ended
+    bool fillBuffer();
+    void close();
+
+public:
+    PuzzleReader();
+    ~PuzzleReader();
+    PuzzleReader(const PuzzleReader&) = delete;
+    PuzzleReader& operator=(const PuzzleReader&) = delete;
+
+    // Open a file, or stdin for "-"; false if it cannot be opened
+    bool open(const std::string& path);
+    // Read the next puzzle into board; a malformed line leaves board unspecified
+    Status next(Board& board);
+    // Position of the line (or packed record) returned by the last call to next
+    std::uint64_t getLineNumber() const;
+    std::uint64_t getLineOffset() const;
+    // Whether reading failed part way through the input
+    bool hasFailed() const;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SOLVE_CACHE_HPP
+#define SOLVE_CACHE_HPP
+
+#include "solverBackend.hpp"
+#include "packedBoard.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Bounded least-recently-used cache of solutions, keyed on canonical puzzles (see canonicalForm.hpp)
+ * so that repeats and symmetric variants of a puzzle share one entry. Keys and solutions are stored
+ * packed, and all storage is allocated up front: entries live in a fixed array, linked in recency
+ * order, and are found through an open-addressing hash table. One cache can serve several solvers
+ * at once; every call takes a lock.
+ */
+class SolveCache {
+
+private:
+    typedef std::array<std::uint8_t, packedBoardSize> PackedBoard;
+
+    // A cached solution, linked into the recency list by entry index
+    struct Entry {
+        PackedBoard key;
+        PackedBoard solution;
+        std::uint64_t hash;
+        int newer;
+        int older;
+    };
+
+    // Marks an unused hash table slot
+    static constexpr int emptySlot = -1;
+
+    mutable std::mutex lock;
+    std::vector<Entry> entries;
+    int entryCount;
+    // Most and least recently used entries, or -1 while the cache is empty
+    int newest;
+    int oldest;
+    // Entry indices, found by linear probing from the hash of their key
+    std::vector<int> slots;
+    std::size_t slotMask;
+    std::uint64_t hits;
+    std::uint64_t misses;
+
+    static std::uint64_t hashKey(const PackedBoard& key);
+    // Slot holding the key, or the empty slot where it would go
+    std::size_t findSlot(const PackedBoard& key, std::uint64_t hash) const;
+    void removeSlot(std::size_t slot);
+    void unlink(int entry);
+    void linkNewest(int entry);
+
+public:
+    // A cache holding up to capacity solutions (at least one)
+    explicit SolveCache(std::size_t capacity);
+    SolveCache(const SolveCache&) = delete;
+    SolveCache& operator=(const SolveCache&) = delete;
+
+    // Look up the solution of a canonical puzzle; true on a hit
+    bool find(const Board& puzzle, Board& solution);
+    // Store the solution of a canonical puzzle, evicting the least recently used one when full
+    void insert(const Board& puzzle, const Board& solution);
+    std::size_t getCapacity() const;
+    std::uint64_t getHits() const;
+    std::uint64_t getMisses() const;
+};
+
+#endif
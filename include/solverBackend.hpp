@@ -0,0 +1,90 @@
+#ifndef SOLVER_BACKEND_HPP
+#define SOLVER_BACKEND_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "boardGeometry.hpp"
+
+// The classic 9x9 board: candidate masks with bit (value - 1) set while value is still possible
+typedef BoardGeometry<3>::Mask CandidateMask;
+// Domain of an empty cell, values 1 to 9
+const CandidateMask allCandidates = BoardGeometry<3>::allCandidates;
+
+// Mask holding the single candidate value
+inline CandidateMask candidateBit(int value){
+    return BoardGeometry<3>::candidateBit(value);
+}
+
+// Candidate masks of the whole board, stored row by row
+typedef BoardGeometry<3>::Domains CellDomains;
+// A 9x9 puzzle as 81 cell values, 0 for an empty cell
+typedef BoardGeometry<3>::Board Board;
+
+// Work done by the last solve or count, the same measures for every backend
+struct SearchStats {
+    // Search states visited, the starting board included
+    std::uint64_t nodes = 0;
+    // Branch points: cells (or exact cover columns) with more than one option left to try
+    std::uint64_t guesses = 0;
+    // Propagation steps: domain reductions for AC-3, column covers for Dancing Links
+    std::uint64_t propagations = 0;
+};
+
+/**
+ * Common interface of the solver backends for boards of one box order. Every backend reads puzzles
+ * in the same format and exposes its board as candidate masks, which the shared output functions
+ * below work from.
+ */
+template<int Order>
+class BasicSolverBackend {
+
+public:
+    typedef BoardGeometry<Order> Geometry;
+    typedef typename Geometry::Mask Mask;
+    typedef typename Geometry::Domains Domains;
+    typedef typename Geometry::Board Board;
+
+    virtual ~BasicSolverBackend() = default;
+    // Initialize board from its compact form; every cell is overwritten
+    virtual void readBoard(const Board& board) = 0;
+    // Initialize board from string: one character per cell in row order, the value symbols
+    // (1-9, then A-Z) for known values and any other character ('0', '.', '*') for empty cells
+    void readBoard(const std::string& board);
+    // Forget the last puzzle and search: every cell open and the counters cleared, as after construction
+    virtual void reset() = 0;
+    // Solve the board that was read last
+    virtual bool solve() = 0;
+    // Read a puzzle and solve it; one instance solves any number of puzzles in turn
+    bool solve(const Board& board);
+    // Count the solutions of the board that was read last, stopping once limit (if not 0) is reached.
+    // Solutions found are appended to the optional list; the board is left holding the last of them.
+    virtual std::size_t countSolutions(std::size_t limit, std::vector<Domains>* solutions = nullptr) = 0;
+    // Candidate masks of all cells; solved cells hold a single value
+    virtual const Domains& getCellValues() const = 0;
+    // Counters of the last solve or count
+    virtual const SearchStats& getSearchStats() const = 0;
+
+    // Initialize board from file
+    bool readBoardFromFiles();
+    // Write the board as one character per cell
+    void writeBoard(char* out) const;
+    // Write the board in compact form, 0 for cells that are not solved
+    void writeBoard(Board& board) const;
+    // Print the current status of the board
+    void printStatus();
+    // Display a welcome message
+    void welcomeMessage();
+    // Display a closing message
+    void endMessage();
+};
+
+// Backends of the classic 9x9 board
+typedef BasicSolverBackend<3> SolverBackend;
+
+// Create a 9x9 backend by name ("ac3", "dlx" or "variant"); empty if the name is unknown
+std::unique_ptr<SolverBackend> makeSolverBackend(const std::string& name);
+
+#endif
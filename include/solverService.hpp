@@ -0,0 +1,169 @@
+#ifndef SOLVER_SERVICE_HPP
+#define SOLVER_SERVICE_HPP
+
+#include "solverBackend.hpp"
+#include "solveCache.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Load and latency of a solver service, as reported by its stats command
+struct ServiceMetrics {
+    // Puzzles received, answered with a solution, answered as unsolvable, and lines that were not understood
+    std::uint64_t requests = 0;
+    std::uint64_t solved = 0;
+    std::uint64_t unsolvable = 0;
+    std::uint64_t malformed = 0;
+    // Batches taken by the workers; requests per batch grow with the load
+    std::uint64_t batches = 0;
+    // Puzzles waiting for a worker now, and the most there ever were
+    std::size_t queueDepth = 0;
+    std::size_t maxQueueDepth = 0;
+    std::size_t connections = 0;
+    // Time from receiving a puzzle to handing its answer back for sending, in microseconds
+    double meanMicros = 0.0;
+    double p50Micros = 0.0;
+    double p99Micros = 0.0;
+    double maxMicros = 0.0;
+};
+
+/**
+ * Long-running solver behind a Unix-domain or loopback TCP socket. Clients send one request per
+ * line and get one line back per request:
+ *
+ *     <puzzle>          ->  <solution> | unsolvable
+ *     <tag> <puzzle>    ->  <tag> <solution> | <tag> unsolvable
+ *     stats             ->  stats requests=... queued=... p99Micros=...
+ *
+ * Puzzles use the puzzle file format (81 characters, 1-9 for clues and '0', '.' or '*' for empty
+ * cells); anything else is answered with "error <reason>", tagged if the line had a tag.
+ *
+ * One thread does all socket I/O with poll() and queues the parsed puzzles. Worker threads, each
+ * with a solver built once at startup, take the queue in batches and hand back the answers, which
+ * the I/O thread sends as soon as they are ready. Answers to puzzles in flight at the same time may
+ * therefore come back in any order; clients that pipeline requests match them up by tag. While the
+ * queue is full, the service stops reading from its clients until the workers catch up, and it stops
+ * reading from a client that leaves too many answers unread.
+ */
+class SolverService {
+
+private:
+    // A parsed puzzle waiting for a worker
+    struct Request {
+        std::uint64_t connection;
+        std::string tag;
+        Board puzzle;
+        std::chrono::steady_clock::time_point received;
+    };
+
+    // An answer waiting for the I/O thread
+    struct Response {
+        std::uint64_t connection;
+        std::string line;
+    };
+
+    // A client socket with its partial input line and unsent output
+    struct Connection {
+        int descriptor;
+        std::string input;
+        std::string output;
+        std::size_t outputOffset;
+        // Puzzles queued or being solved whose answers have not reached the output yet
+        std::size_t pending;
+        // Skipping the rest of an overlong line
+        bool discardingLine;
+        // The client has closed its end; the connection closes once every answer is sent
+        bool inputClosed;
+    };
+
+    // Most puzzles a worker takes from the queue at once
+    static const std::size_t maxBatchSize = 64;
+    // Queue depth at which the service stops reading from its clients
+    static const std::size_t maxQueueDepth = 1 << 16;
+    // Unsent output at which the service stops reading from a client
+    static const std::size_t maxUnsentOutput = 1 << 20;
+    // Longest request line; a tag, a space and a puzzle fit easily
+    static const std::size_t maxLineLength = 1024;
+    // Latency histogram buckets: four per power of two of nanoseconds
+    static const int latencyBucketCount = 256;
+
+    unsigned threadCount;
+    // Name of the solver backend every worker creates
+    std::string engine;
+    // Solution cache shared by the workers of the AC-3 engine, if any
+    SolveCache* solveCache;
+    int listener;
+    // Written by the workers and stop() to wake the I/O thread from poll()
+    int wakePipe[2];
+    std::string address;
+    // Socket file to remove on close, for Unix-domain sockets
+    std::string socketPath;
+    std::atomic<bool> stopRequested;
+
+    // Connections by id; ids are never reused, so answers for a closed connection are dropped
+    std::unordered_map<std::uint64_t, Connection> connections;
+    std::uint64_t nextConnection;
+
+    // Shared with the workers
+    mutable std::mutex lock;
+    std::condition_variable requestsAvailable;
+    std::deque<Request> requests;
+    std::vector<Response> responses;
+    bool stopping;
+    ServiceMetrics metrics;
+    std::array<std::uint64_t, latencyBucketCount> latencyBuckets;
+    std::uint64_t latencyTotal;
+    std::uint64_t latencyMax;
+
+    // Create, bind and listen on the socket of an address
+    bool listenUnix(const std::string& path);
+    bool listenTcp(const std::string& hostPort);
+    // Accept every pending client
+    void acceptClients();
+    // Read what a client sent and queue its complete lines; false once the client is gone
+    bool readClient(std::uint64_t id, Connection& connection);
+    // Answer or queue one request line
+    void handleLine(std::uint64_t id, Connection& connection, const char* line, std::size_t length);
+    // Answer a line over maxLineLength with an error
+    void rejectLongLine(Connection& connection);
+    // Send as much queued output as the socket takes; false on an error
+    bool writeClient(Connection& connection);
+    // Move the workers' answers to the output of their connections
+    void collectResponses();
+    // Solve queued puzzles in batches until the service stops
+    void runWorker();
+    void wake();
+    void recordLatency(std::uint64_t nanoseconds);
+    double latencyPercentile(double fraction) const;
+    std::string formatMetrics() const;
+
+public:
+    // A thread count of 0 uses every available core; engine names a backend known to makeSolverBackend
+    explicit SolverService(unsigned threadCount = 0, const std::string& engine = "ac3");
+    ~SolverService();
+    SolverService(const SolverService&) = delete;
+    SolverService& operator=(const SolverService&) = delete;
+
+    // Let every AC-3 worker consult the cache (nullptr for none); it must outlive the service
+    void setSolveCache(SolveCache* cache);
+    // Listen on "unix:<path>", a path containing '/', or "[host:]port" on a loopback address (port 0 picks a free one)
+    bool open(const std::string& address);
+    // Serve clients until stop() is called
+    bool run();
+    // Make run() return; safe to call from a signal handler
+    void stop();
+    // The address the service listens on, with the actual port for TCP
+    const std::string& getAddress() const;
+    ServiceMetrics getMetrics() const;
+    unsigned getThreadCount() const;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SOLVER_STATS_HPP
+#define SOLVER_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+
+// Detailed solver statistics are compiled in with -DSUDOKU_STATS=1 (make STATS=1). Without it,
+// every counter update and phase timer compiles away and the solver runs as fast as before.
+#ifndef SUDOKU_STATS
+#define SUDOKU_STATS 0
+#endif
+
+// Whether this build collects the detailed statistics
+constexpr bool solverStatsEnabled = SUDOKU_STATS != 0;
+
+// Phases of the solve that are timed separately
+enum SolverPhase {
+    // Whole-board elimination and unit seeding before the search (propagateAll)
+    initialPropagationPhase,
+    // Propagation after each guess
+    guessPropagationPhase,
+    // Choosing the next cell to guess
+    guessSelectionPhase,
+    // Rolling the trail back on backtracking
+    rollbackPhase,
+    solverPhaseCount
+};
+
+/**
+ * Counters and phase timers of the AC-3 solver, collected only when SUDOKU_STATS is enabled.
+ * They are cleared when a board is read and when a search starts, so a solve reports just that
+ * solve, and inferAC3 or inferAC3Improved after readBoard report just their own work.
+ */
+struct SolverStats {
+    // Arc revisions: arcs taken off the inferAC3 queue, and peers checked against a solved cell by
+    // the propagation engine (eliminateSolved)
+    std::uint64_t arcsProcessed = 0;
+    // Runs of the whole-grid elimination kernel, which does the initial elimination of a 9x9 board
+    // without revising arcs one by one
+    std::uint64_t kernelRuns = 0;
+    // Candidates removed from the domains of cells
+    std::uint64_t valuesRemoved = 0;
+    // Values placed because they fit only one cell of a unit
+    std::uint64_t hiddenSingles = 0;
+    // Trail rollbacks, one per abandoned guess
+    std::uint64_t rollbacks = 0;
+    // Deepest guess level reached
+    int maxDepth = 0;
+    // Steady-clock time spent in each SolverPhase
+    double phaseSeconds[solverPhaseCount] = {};
+};
+
+/**
+ * Adds the time between its construction and destruction to a phase of the statistics.
+ * The disabled specialization below is empty, so timing costs nothing unless SUDOKU_STATS is set.
+ */
+template<bool Enabled = solverStatsEnabled>
+class PhaseTimer {
+private:
+    SolverStats& stats;
+    SolverPhase phase;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    PhaseTimer(SolverStats& stats, SolverPhase phase) : stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer(){
+        stats.phaseSeconds[phase] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+template<>
+class PhaseTimer<false> {
+public:
+    PhaseTimer(SolverStats&, SolverPhase) {}
+};
+
+#endif
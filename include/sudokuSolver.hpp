@@ -1,91 +1,291 @@
-#include <set>
-#include <unordered_set>
-#include <unordered_map>
-#include <queue>
-
-// Hash function for std::pair<int, int>, used in unordered maps and sets
-struct pairHashing{
-    std::size_t operator()(const std::pair<int, int>& pair) const {
-        std::size_t hash1 = std::hash<int>{}(pair.first);
-        std::size_t hash2 = std::hash<int>{}(pair.second);
-        // Combine the hashes by shifting and XOR
-        return hash1 ^ (hash2 << 1);
-    }
+#ifndef SUDOKU_SOLVER_HPP
+#define SUDOKU_SOLVER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "solverBackend.hpp"
+#include "solverStats.hpp"
+#include "sudokuTopology.hpp"
+
+class SolveCache;
+
+// How the search picks the cell to guess on next
+enum CellSelection {
+    // Fewest candidates left (minimum remaining values), the first such cell in row order
+    minimumRemainingValues,
+    // Fewest candidates left; ties go to the cell with the most unsolved peers (degree)
+    degreeTieBreak,
+    cellSelectionCount
 };
 
-// Hash function for std::pair<std::pair<int, int>, std::pair<int, int>>
-struct pairOfPairHashing{
-    std::size_t operator()(const std::pair<std::pair<int, int>, std::pair<int, int>>& pairOfPair) const {
-        std::size_t hash1 = std::hash<int>{}(pairOfPair.first.first);
-        std::size_t hash2 = std::hash<int>{}(pairOfPair.first.second);
-        // Combine the hashes by shifting and XOR
-        return hash1 ^ (hash2 << 1);
-    }
+// Order in which the values of a guessed cell are tried
+enum ValueOrdering {
+    // Smallest value first
+    ascendingValues,
+    // Values held by the fewest unsolved peers first, since they remove the fewest candidates
+    leastConstrainingValue,
+    // Values with the fewest other places in one of the cell's units first, the closest to a hidden single
+    hiddenSingleValues,
+    valueOrderingCount
 };
 
-// Comparator for priority queue where pairs are sorted by the first element
-struct cellComparator{
-    // overloading the function call operator '()' for a class/struct.
-    // '()' operator allows the instances of the class/struct to be called as if they were functions.
-    bool operator()(const std::pair<int, std::pair<int, int>>& a, const std::pair<int, std::pair<int, int>>& b) const{
-        return a.first > b.first;
-    }
+// Name of a cell selection ("mrv" or "degree")
+const char* cellSelectionName(CellSelection selection);
+// Name of a value ordering ("ascending", "lcv" or "hidden")
+const char* valueOrderingName(ValueOrdering ordering);
+
+// Branching heuristics of the backtracking search. No combination was clearly ahead in solverBench
+// on puzzles that none of them graded (see the README), so the default is the cheapest per node.
+struct BranchingStrategy {
+    CellSelection cellSelection = minimumRemainingValues;
+    ValueOrdering valueOrdering = ascendingValues;
+};
+
+
+// How the value of a hint was found, from the simplest technique to the fallbacks
+enum HintTechnique {
+    // The cell has a single candidate left once the placed values are removed from its peers
+    nakedSingleHint,
+    // The value fits in no other cell of one of the cell's units
+    hiddenSingleHint,
+    // A single appears after pointing or box-line reductions
+    intersectionHint,
+    // A single appears after removing naked pairs or triples
+    nakedSubsetHint,
+    // A single appears after removing hidden pairs or triples
+    hiddenSubsetHint,
+    // No technique of the propagation engine applies; the value is taken from the solution
+    solutionHint,
+    // A placed value is not part of the solution; the hint names the cell and its correct value
+    mistakeHint,
+    // Every cell is filled, or the puzzle has no solution
+    noHint,
+    hintTechniqueCount
+};
+
+// Name of a technique, e.g. "hidden single"
+const char* hintTechniqueName(HintTechnique technique);
+
+// The next value to place, and the technique that finds it
+struct SudokuHint {
+    int cell = -1;
+    int value = 0;
+    HintTechnique technique = noHint;
 };
 
 
-class SudokuSolver {
-    
+/**
+ * Hooks that let other threads steer a running search: abandon it early,
+ * or take over guesses it has not tried yet.
+ */
+template<int Order>
+class BasicSearchControl {
+public:
+    virtual ~BasicSearchControl() = default;
+    // Checked before every guess; returning true abandons the search
+    virtual bool isCancelled() const = 0;
+    // Whether another worker is waiting for work
+    virtual bool wantsWork() const = 0;
+    // Receives a board whose search should continue elsewhere
+    virtual void shareWork(const typename BoardGeometry<Order>::Domains& cells) = 0;
+};
+
+typedef BasicSearchControl<3> SearchControl;
+
+
+/**
+ * Constraint propagation (AC-3 and stronger unit rules) combined with backtracking search, for
+ * boards of the given box order. Every size and mask width is a compile-time constant of the
+ * instantiation, and all working storage lives inside the object: a 9x9 solver takes a few
+ * kilobytes, while a 36x36 one takes over a megabyte and should live on the heap.
+ *
+ * That storage (domains, trail, guess stack and propagation queues) is the solver's
+ * arena: it is sized for the worst case once, and every solve works in it from the start again,
+ * so an instance can be reused for any number of puzzles without touching the heap.
+ */
+template<int Order>
+class BasicSudokuSolver : public BasicSolverBackend<Order> {
+
+public:
+    typedef BoardGeometry<Order> Geometry;
+    typedef BasicSudokuTopology<Order> Topology;
+    typedef typename Geometry::Mask Mask;
+    typedef typename Geometry::Domains Domains;
+    typedef typename Geometry::CellId CellId;
+    typedef typename Geometry::ArcId ArcId;
+
 private:
-    // Set of all possible cell indices in the Sudoku grid
-    std::set<std::pair<int, int>> cellIndices;
-    // Map of each cell index to its possible values
-    std::unordered_map<std::pair<int, int>, std::unordered_set<int>, pairHashing> cellValues;
-    // Maps for neighbors: Row, Column, and Block
-    std::unordered_map<std::pair<int, int>, std::unordered_set<std::pair<int, int>, pairHashing>, pairHashing> rowNeighbors;
-    std::unordered_map<std::pair<int, int>, std::unordered_set<std::pair<int, int>, pairHashing>, pairHashing> colNeighbors;
-    std::unordered_map<std::pair<int, int>, std::unordered_set<std::pair<int, int>, pairHashing>, pairHashing> blockNeighbors;
-    // Map of all neighbors combined
-    std::unordered_map<std::pair<int, int>, std::unordered_set<std::pair<int, int>, pairHashing>, pairHashing> allNeighbors;
-    // Set of all arcs used for solving algorithms
-    std::unordered_set<std::pair<std::pair<int, int>, std::pair<int, int>>, pairOfPairHashing> arcs;
+    // Previous domain of a cell, recorded before the domain is narrowed so it can be rolled back
+    struct TrailEntry {
+        CellId cell;
+        Mask mask;
+    };
+
+    // One guess of the backtracking search: the cell, its values not tried yet and the trail position before the guess
+    struct SearchFrame {
+        CellId cell;
+        Mask untried;
+        int trailMark;
+    };
+
+    // A value placed during a hint session, with the trail position before it
+    struct Placement {
+        CellId cell;
+        Mask value;
+        int trailMark;
+    };
+
+    // Candidate mask of each cell, stored row by row
+    Domains cellValues;
+    // Undo log of domain changes. Every change removes at least one candidate of one cell,
+    // so a single search path can never record more entries than there are candidates.
+    std::array<TrailEntry, Geometry::cellCount * Geometry::size> trail;
+    int trailSize;
+    // Most recent solution found while counting solutions
+    Domains lastSolution;
+    // Explicit guess stack replacing recursion; each level fixes a different cell
+    std::array<SearchFrame, Geometry::cellCount> searchStack;
+    // Ring buffer of pending arc positions for AC3, each arc queued at most once
+    std::array<ArcId, Geometry::arcCount> arcQueue;
+    std::array<bool, Geometry::arcCount> arcQueued;
+    // Work lists of the propagation engine: cells that just became solved (each is added once,
+    // when its domain shrinks to a single value) and a ring of units whose cells have changed
+    std::array<CellId, Geometry::cellCount> solvedQueue;
+    int solvedCount;
+    std::array<std::uint8_t, Geometry::unitCount> unitQueue;
+    std::array<bool, Geometry::unitCount> unitQueued;
+    int unitHead;
+    int unitPending;
+    // Counters of the last search
+    SearchStats stats;
+    // Detailed counters and phase timers of the last search, kept only with SUDOKU_STATS
+    SolverStats solverStats;
+    // Optional cache of solutions shared with other solvers, consulted by inferAC3Guessing
+    SolveCache* solveCache;
+    // Heuristics choosing the guesses of the search
+    BranchingStrategy branching;
+    // Hint session (sudokuHints.cpp): values placed on top of the clues, oldest first, and which
+    // cells hold a clue or a placed value
+    std::array<Placement, Geometry::cellCount> placements;
+    int placementCount;
+    std::array<bool, Geometry::cellCount> cellPlaced;
+    // The puzzle's solution, found once when the session starts, if it has one
+    Domains sessionSolution;
+    bool sessionSolved;
+    // Whether the clues are consistent once their values are eliminated from their peers; a session
+    // on clashing clues refuses every placement and hint
+    bool sessionConsistent;
+    // Whether a session is running; anything that loads a board or searches ends it
+    bool sessionActive;
     // Private member functions for internal calculations
-    std::unordered_set<std::pair<int, int>, pairHashing> getRowNeighbors(const std::pair<int, int>& target) const;
-    std::unordered_set<std::pair<int, int>, pairHashing> getColNeighbors(const std::pair<int, int>& target) const;
-    std::unordered_set<std::pair<int, int>, pairHashing> getBlockNeighbors(const std::pair<int, int>& target) const;
-    
-    std::unordered_set<std::pair<std::pair<int, int>, std::pair<int, int>>, pairOfPairHashing> getArcs();
-    
+    // Units, neighbors and arcs are served from the shared topology tables
+    static const Topology& topology(){
+        return sudokuTopologyOf<Order>();
+    }
+    const typename Topology::UnitPeers& getRowNeighbors(int cell) const;
+    const typename Topology::UnitPeers& getColNeighbors(int cell) const;
+    const typename Topology::UnitPeers& getBlockNeighbors(int cell) const;
+
+    const std::array<typename Topology::Arc, Geometry::arcCount>& getArcs() const;
+
     // Check if the Sudoku is solved
     bool isSolved() const;
     // Enforce consistency between pairs
     // Note this function works regardless of arcs
-    bool removeInconsistentValue(const std::pair<int, int>& index1, const std::pair<int, int>& index2);
-    // Validate candidate numbers
-    bool isCandidateValid(int candidate, const std::unordered_set<std::pair<int, int>, pairHashing>& neighbors);
-    
-    
+    bool removeInconsistentValue(int cell1, int cell2);
+    // Narrow a cell's domain, recording the previous one on the trail
+    void setCellValues(int cell, Mask mask);
+    // Roll the board back to an earlier trail position
+    void undoTrail(int trailMark);
+    // Propagation engine (sudokuPropagation.cpp)
+    // Narrow a cell's domain and queue the work that follows from it
+    bool narrowCell(int cell, Mask mask);
+    void clearPropagationQueues();
+    // Deduction rules applied to a single unit
+    bool applyHiddenSingles(int unit);
+    bool applyIntersections(int unit);
+    bool applyNakedSubsets(int unit);
+    bool applyHiddenSubsets(int unit);
+    // Remove the values of queued solved cells from their peers, and of the cells this solves in turn; false on a contradiction
+    bool eliminateSolved();
+    // Process queued work until nothing changes; false on a contradiction
+    bool propagate();
+    // Queue every solved cell and every unit, then propagate
+    bool propagateAll();
+    // Branching heuristics (sudokuBranching.cpp)
+    // Pick the cell to guess on with the cell selection of the branching strategy
+    int selectGuessCell() const;
+    // Pick the next value to try of a guess level with the value ordering of the branching strategy
+    int selectGuessValue(const SearchFrame& frame) const;
+    // Hint session helpers (sudokuHints.cpp)
+    // Narrow a cell to a value and eliminate from there, undoing everything on a contradiction
+    bool applyPlacement(int cell, Mask value);
+    // An unplaced cell with a single candidate, or -1
+    int findUnplacedSingle() const;
+    // The first single the unit rules lead to, trying the weaker rules first; changes the board
+    SudokuHint findTechniqueHint();
+    // Hand the untried guesses of the shallowest open level to the search control
+    void shareUntriedGuesses(int depth, BasicSearchControl<Order>& control);
+    // Backtracking search shared by inferAC3Guessing and countSolutions
+    std::size_t search(BasicSearchControl<Order>* control, std::size_t limit, std::vector<Domains>* solutions);
+    // inferAC3Guessing through the solve cache (9x9 only)
+    bool searchCached();
+
+
 public:
-    SudokuSolver();
-    // Initialize board from string
-    void readBoard(const std::string& board);
-    // Initialize board from file
-    bool readBoardFromFiles();
+    BasicSudokuSolver();
+    typedef typename Geometry::Board Board;
+    // Initialize board from its compact form; the string form is parsed by the base class
+    using BasicSolverBackend<Order>::readBoard;
+    void readBoard(const Board& board) override;
+    // Open every cell, empty the trail and the propagation queues and clear the counters; the solve cache stays set
+    void reset() override;
+    // Solve with inferAC3Guessing; solve(const Board&) reads the puzzle first
+    using BasicSolverBackend<Order>::solve;
+    bool solve() override;
+    // Access the candidate masks of all cells
+    const Domains& getCellValues() const override;
+    const SearchStats& getSearchStats() const override;
+    // Detailed statistics since the board was read or the last search started; all zero unless built with SUDOKU_STATS
+    const SolverStats& getSolverStats() const;
+    void loadCellValues(const Domains& cells);
     // Apply AC3 algorithm
     void inferAC3();
     // Apply improved version of AC3(Enhanced Constraint Propagation)
     void inferAC3Improved();
-    // Apply AC3 with guessing enhancement(Backtracking)
-    bool inferAC3Guessing();
-    // Print the current status of the board
-    void printStatus();
-    // Display a welcome message
-    void welcomeMessage();
-    // Display a closing message
-    void endMessage();
-    ~SudokuSolver() = default;
+    // Put a solve cache in front of inferAC3Guessing, or remove it with nullptr (9x9 only; other sizes ignore it)
+    void setSolveCache(SolveCache* cache);
+    // Choose the branching heuristics of the search; they stay set across reset
+    void setBranching(const BranchingStrategy& strategy);
+    const BranchingStrategy& getBranching() const;
+    // Apply AC3 with guessing enhancement(Backtracking), optionally steered by a search control
+    bool inferAC3Guessing(BasicSearchControl<Order>* control = nullptr);
+    // Count solutions up to a limit, optionally collecting them
+    std::size_t countSolutions(std::size_t limit, std::vector<Domains>* solutions = nullptr) override;
+    // Start a hint session on the board read last, whose solved cells are its clues; false if it has no solution.
+    // If the clues clash, the board is left as read and the session refuses every placement and hint.
+    // The session lasts until the next readBoard, reset or solve.
+    bool startHints();
+    // Place a value in an open cell, eliminating it from the cell's peers; false if it conflicts or the clues
+    // clash, leaving the board as it was
+    bool place(int cell, int value);
+    // Take back a placed value (not a clue); false if the cell holds none
+    bool unplace(int cell);
+    // The next value to place and how it is found, or technique noHint if the clues clash; the board is left as it is
+    SudokuHint nextHint();
+    ~BasicSudokuSolver() = default;
 };
 
-// Overloads the output stream operator to print the contents of an unordered set of different types of elements.
-std::ostream& operator<<(std::ostream& os, const std::unordered_set<int>& set);
-std::ostream& operator<<(std::ostream& os, const std::unordered_set<std::pair<int, int>>& set);
-std::ostream& operator<<(std::ostream& os, const std::unordered_set<std::pair<std::pair<int, int>, std::pair<int, int>>>& set);
+// The classic 9x9 solver
+typedef BasicSudokuSolver<3> SudokuSolver;
+
+// Instantiated in sudokuSolver.cpp, with members defined in sudokuPropagation.cpp, sudokuBranching.cpp and sudokuHints.cpp
+extern template class BasicSudokuSolver<2>;
+extern template class BasicSudokuSolver<3>;
+extern template class BasicSudokuSolver<4>;
+extern template class BasicSudokuSolver<5>;
+extern template class BasicSudokuSolver<6>;
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef SUDOKU_TOPOLOGY_HPP
+#define SUDOKU_TOPOLOGY_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "boardGeometry.hpp"
+
+/**
+ * Constraint graph of a board of the given box order: its units, the peers of every cell and
+ * every arc between peers. For the 9x9 board that is 27 units, 20 peers per cell and 1620 arcs.
+ */
+template<int Order>
+struct BasicSudokuTopology {
+    typedef BoardGeometry<Order> Geometry;
+    typedef typename Geometry::CellId CellId;
+    typedef typename Geometry::ArcId ArcId;
+    // The other cells sharing one unit (row, column or block) with a cell
+    typedef std::array<CellId, Geometry::size - 1> UnitPeers;
+
+    // A directed arc of the constraint graph: the domain of 'from' depends on 'to'
+    struct Arc {
+        CellId from;
+        CellId to;
+    };
+
+    // Cells of every unit: rows first, then columns, then blocks
+    std::array<std::array<CellId, Geometry::size>, Geometry::unitCount> units;
+    // The row, column and block unit of each cell, in that order
+    std::array<std::array<std::uint8_t, 3>, Geometry::cellCount> cellUnits;
+    // Peers of each cell per unit type
+    std::array<UnitPeers, Geometry::cellCount> rowPeers;
+    std::array<UnitPeers, Geometry::cellCount> colPeers;
+    std::array<UnitPeers, Geometry::cellCount> blockPeers;
+    // All distinct peers of each cell
+    std::array<std::array<CellId, Geometry::peerCount>, Geometry::cellCount> peers;
+    // Every (cell, peer) arc, grouped by cell: arcs[cell * peerCount + k].to == peers[cell][k]
+    std::array<Arc, Geometry::arcCount> arcs;
+    // Position of the opposite arc: arcs[reverseArcs[i]] runs from arcs[i].to to arcs[i].from
+    std::array<ArcId, Geometry::arcCount> reverseArcs;
+};
+
+/**
+ * Fills the topology tables of a board. Usable in constant expressions, so the 9x9 tables
+ * are computed by the compiler.
+ *
+ * @param topology The tables to fill.
+ */
+template<int Order>
+constexpr void buildSudokuTopology(BasicSudokuTopology<Order>& topology){
+    typedef BasicSudokuTopology<Order> Topology;
+    typedef typename Topology::CellId CellId;
+    constexpr int size = Topology::Geometry::size;
+    constexpr int cellCount = Topology::Geometry::cellCount;
+    constexpr int peerCount = Topology::Geometry::peerCount;
+
+    for(int row=0; row<size; ++row){
+        for(int col=0; col<size; ++col){
+            int cell = row * size + col;
+            int block = (row / Order) * Order + col / Order;
+            int blockCell = (row % Order) * Order + col % Order;
+            topology.units[row][col] = static_cast<CellId>(cell);
+            topology.units[size + col][row] = static_cast<CellId>(cell);
+            topology.units[2 * size + block][blockCell] = static_cast<CellId>(cell);
+            topology.cellUnits[cell] = {static_cast<std::uint8_t>(row), static_cast<std::uint8_t>(size + col),
+                                        static_cast<std::uint8_t>(2 * size + block)};
+        }
+    }
+    for(int cell=0; cell<cellCount; ++cell){
+        int row = cell / size;
+        int col = cell % size;
+        int blockRow = row - row % Order;
+        int blockCol = col - col % Order;
+        int rowCount = 0, colCount = 0, blockCount = 0, peerIndex = 0;
+        for(int other=0; other<cellCount; ++other){
+            if(other == cell){
+                continue;
+            }
+            int otherRow = other / size;
+            int otherCol = other % size;
+            bool sameRow = otherRow == row;
+            bool sameCol = otherCol == col;
+            bool sameBlock = otherRow - otherRow % Order == blockRow && otherCol - otherCol % Order == blockCol;
+            if(sameRow){
+                topology.rowPeers[cell][rowCount++] = static_cast<CellId>(other);
+            }
+            if(sameCol){
+                topology.colPeers[cell][colCount++] = static_cast<CellId>(other);
+            }
+            if(sameBlock){
+                topology.blockPeers[cell][blockCount++] = static_cast<CellId>(other);
+            }
+            if(sameRow || sameCol || sameBlock){
+                topology.peers[cell][peerIndex] = static_cast<CellId>(other);
+                topology.arcs[cell * peerCount + peerIndex] = typename Topology::Arc{static_cast<CellId>(cell), static_cast<CellId>(other)};
+                ++peerIndex;
+            }
+        }
+    }
+    for(int arc=0; arc<Topology::Geometry::arcCount; ++arc){
+        int to = topology.arcs[arc].to;
+        for(int k=0; k<peerCount; ++k){
+            if(topology.peers[to][k] == topology.arcs[arc].from){
+                topology.reverseArcs[arc] = static_cast<typename Topology::ArcId>(to * peerCount + k);
+            }
+        }
+    }
+}
+
+// Builds the topology tables of a board by value; only meant to be evaluated at compile time.
+template<int Order>
+constexpr BasicSudokuTopology<Order> makeSudokuTopology(){
+    BasicSudokuTopology<Order> topology{};
+    buildSudokuTopology(topology);
+    return topology;
+}
+
+// The classic 9x9 board
+typedef BasicSudokuTopology<3> SudokuTopology;
+typedef SudokuTopology::CellId CellId;
+typedef SudokuTopology::UnitPeers UnitPeers;
+typedef SudokuTopology::Arc Arc;
+
+// The 9x9 tables are a compile-time constant, baked into the binary and shared by every solver
+// instance without any runtime setup
+inline constexpr SudokuTopology sudokuTopology = makeSudokuTopology<3>();
+
+/**
+ * The topology of a board of the given order. The 9x9 tables are the compile-time constant above;
+ * the tables of the other orders grow too large for compile-time evaluation (over a megabyte for
+ * 36x36), so they are built on the heap on first use and kept for the rest of the program.
+ *
+ * @return The shared topology tables.
+ */
+template<int Order>
+inline const BasicSudokuTopology<Order>& sudokuTopologyOf(){
+    if constexpr(Order == 3){
+        return sudokuTopology;
+    } else {
+        static const std::unique_ptr<const BasicSudokuTopology<Order>> topology = []{
+            std::unique_ptr<BasicSudokuTopology<Order>> tables(new BasicSudokuTopology<Order>());
+            buildSudokuTopology(*tables);
+            return std::unique_ptr<const BasicSudokuTopology<Order>>(std::move(tables));
+        }();
+        return *topology;
+    }
+}
+
+#endif
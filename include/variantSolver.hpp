@@ -0,0 +1,94 @@
+#ifndef VARIANT_SOLVER_HPP
+#define VARIANT_SOLVER_HPP
+
+#include "solverBackend.hpp"
+#include "variantTopology.hpp"
+#include <array>
+#include <vector>
+
+/**
+ * Constraint propagation and backtracking search for 9x9 variants, driven by a compiled
+ * VariantTopology instead of the fixed tables of the classic solver. Diagonals and jigsaw regions
+ * are just more units, and killer cages are constraints of their own. Propagation uses three rules:
+ * - the value of a solved cell is removed from its peers;
+ * - a value with a single place left in a unit is placed there (hidden single);
+ * - the cells of a cage keep only the values of the sum combinations that still fit the cage.
+ *   A value that every remaining combination needs and only one cell of the cage can hold is
+ *   placed there.
+ *
+ * Like the classic solver, it works in storage sized once for the worst case and undoes guesses
+ * through a trail, so an instance solves any number of puzzles without touching the heap.
+ */
+class VariantSolver : public SolverBackend {
+
+private:
+    // Units, then cages, share one work queue
+    static const int maxConstraints = VariantTopology::maxUnits + VariantTopology::maxCages;
+
+    // Previous domain of a cell, recorded before the domain is narrowed so it can be rolled back
+    struct TrailEntry {
+        CellId cell;
+        CandidateMask mask;
+    };
+
+    // One guess of the backtracking search: the cell, its values not tried yet and the trail position before the guess
+    struct SearchFrame {
+        CellId cell;
+        CandidateMask untried;
+        int trailMark;
+    };
+
+    VariantTopology topology;
+    CellDomains cellValues;
+    // Every trail entry removes at least one of the 729 candidates
+    std::array<TrailEntry, 81 * 9> trail;
+    int trailSize;
+    std::array<SearchFrame, 81> searchStack;
+    // Most recent solution found while counting solutions
+    CellDomains lastSolution;
+    // Cells that just became solved, and a ring of constraints whose cells have changed
+    std::array<CellId, 81> solvedQueue;
+    int solvedCount;
+    std::array<std::uint8_t, maxConstraints> constraintQueue;
+    std::array<bool, maxConstraints> constraintQueued;
+    int constraintHead;
+    int constraintPending;
+    // Counters of the last search
+    SearchStats stats;
+
+    // Narrow a cell's domain, recording the previous one on the trail and queueing the work that follows
+    bool narrowCell(int cell, CandidateMask mask);
+    void queueConstraint(int constraint);
+    void clearPropagationQueues();
+    void undoTrail(int trailMark);
+    // Rules of one unit and one cage; false on a contradiction
+    bool applyUnit(int unit);
+    bool applyCage(int cage);
+    // Remove the values of queued solved cells from their peers; false on a contradiction
+    bool eliminateSolved();
+    // Process queued work until nothing changes, optionally queueing everything first; false on a contradiction
+    bool propagate(bool everything);
+    // The unsolved cell with the fewest candidates, or -1 if every cell is solved
+    int selectGuessCell() const;
+    // Backtracking search shared by solve and countSolutions
+    std::size_t search(std::size_t limit, std::vector<CellDomains>* solutions);
+
+public:
+    // A solver for the classic rules
+    VariantSolver();
+    explicit VariantSolver(const VariantTopology& variant);
+    // Solve the following puzzles under other rules
+    void setTopology(const VariantTopology& variant);
+    const VariantTopology& getTopology() const;
+    using SolverBackend::readBoard;
+    void readBoard(const Board& board) override;
+    // Open every cell and clear the counters; the rules stay set
+    void reset() override;
+    using SolverBackend::solve;
+    bool solve() override;
+    std::size_t countSolutions(std::size_t limit, std::vector<CellDomains>* solutions = nullptr) override;
+    const CellDomains& getCellValues() const override;
+    const SearchStats& getSearchStats() const override;
+};
+
+#endif
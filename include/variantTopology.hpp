@@ -0,0 +1,154 @@
+#ifndef VARIANT_TOPOLOGY_HPP
+#define VARIANT_TOPOLOGY_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "solverBackend.hpp"
+#include "sudokuTopology.hpp"
+
+// A killer cage: its cells hold distinct values that add up to the sum
+struct KillerCage {
+    int sum = 0;
+    // Cells in row order of the board, 0 to 80
+    std::vector<int> cells;
+};
+
+// Rules of a 9x9 variant; every variant keeps the rows and columns of the classic board
+struct VariantRules {
+    // Both long diagonals hold every value once (X-Sudoku)
+    bool diagonals = false;
+    // Region of every cell, 0 to 8, for irregular (jigsaw) regions; empty for the classic 3x3 blocks
+    std::vector<int> regions;
+    // Killer cages; a cell belongs to at most one
+    std::vector<KillerCage> cages;
+};
+
+/**
+ * Value sets of every killer cage: for each cell count and sum, the masks of the distinct values
+ * from 1 to 9 that add up to the sum. All 511 non-empty value sets are listed once, grouped by
+ * cell count and sum, so a cage looks up its combinations as a range of the table.
+ */
+struct SumCombinations {
+    // Largest sum of distinct values 1 to 9
+    static constexpr int maxSum = 45;
+    static constexpr int keyCount = 10 * (maxSum + 1);
+
+    // Position of the combinations of a cell count and sum in the masks
+    static constexpr int key(int cellCount, int sum){
+        return cellCount * (maxSum + 1) + sum;
+    }
+
+    std::array<CandidateMask, 511> masks;
+    // The combinations of a key are masks[first[key]] up to masks[first[key + 1]]
+    std::array<std::uint16_t, keyCount + 1> first;
+    // Union of the combinations of a key: the values a cell of such a cage can hold
+    std::array<CandidateMask, keyCount> candidates;
+};
+
+// Builds the sum combinations table; only meant to be evaluated at compile time.
+constexpr SumCombinations makeSumCombinations(){
+    SumCombinations table{};
+    // Key of every value set, from its number of values and their sum
+    std::array<int, 512> keys{};
+    for(int mask=1; mask<512; ++mask){
+        int count = 0, sum = 0;
+        for(int value=1; value<=9; ++value){
+            if(mask & (1 << (value - 1))){
+                ++count;
+                sum += value;
+            }
+        }
+        keys[mask] = SumCombinations::key(count, sum);
+        ++table.first[keys[mask] + 1];
+        table.candidates[keys[mask]] |= static_cast<CandidateMask>(mask);
+    }
+    for(int key=0; key<SumCombinations::keyCount; ++key){
+        table.first[key + 1] += table.first[key];
+    }
+    // Counting sort: place every mask at the next free position of its key
+    std::array<std::uint16_t, SumCombinations::keyCount> next{};
+    for(int key=0; key<SumCombinations::keyCount; ++key){
+        next[key] = table.first[key];
+    }
+    for(int mask=1; mask<512; ++mask){
+        table.masks[next[keys[mask]]++] = static_cast<CandidateMask>(mask);
+    }
+    return table;
+}
+
+// The combinations are a compile-time constant, like the classic topology
+inline constexpr SumCombinations sumCombinations = makeSumCombinations();
+
+/**
+ * Constraint graph of a 9x9 variant, compiled from its rules. Units are the groups of nine cells
+ * that hold every value once: rows, columns, regions (the 3x3 blocks or jigsaw regions) and
+ * optionally the two diagonals. Cages are the killer cages with the range of their sum
+ * combinations. Two cells are peers if they share a unit or a cage.
+ *
+ * Every table has a fixed capacity, so a solver holds its topology without heap storage. The
+ * classic rules compile to the units and peers of sudokuTopology, in the same order.
+ */
+struct VariantTopology {
+    // 9 rows, 9 columns, 9 regions and 2 diagonals
+    static const int maxUnits = 29;
+    // A row, a column, a region and both diagonals for the center cell
+    static const int maxCellUnits = 5;
+    // Cages hold at least one cell each
+    static const int maxCages = 81;
+    static const int maxPeers = 80;
+
+    struct Cage {
+        std::uint8_t cellCount;
+        std::uint8_t sum;
+        std::array<CellId, 9> cells;
+    };
+
+    int unitCount;
+    std::array<std::array<CellId, 9>, maxUnits> units;
+    // Units of each cell: row, column and region first, then any diagonals
+    std::array<std::uint8_t, 81> cellUnitCount;
+    std::array<std::array<std::uint8_t, maxCellUnits>, 81> cellUnits;
+    int cageCount;
+    std::array<Cage, maxCages> cages;
+    // Cage of each cell, -1 for none
+    std::array<std::int8_t, 81> cellCage;
+    // Distinct peers of each cell
+    std::array<std::uint8_t, 81> peerCount;
+    std::array<std::array<CellId, maxPeers>, 81> peers;
+};
+
+/**
+ * Compiles the rules of a variant into its constraint graph, checking that they describe a board:
+ * nine regions of nine cells, and cages of one to nine distinct cells that no other cage shares,
+ * with a sum that distinct values can add up to.
+ *
+ * @param rules The rules.
+ * @param topology Receives the tables.
+ * @param error Receives the reason the rules are invalid.
+ * @return true if the rules are valid, false otherwise.
+ */
+bool compileVariantTopology(const VariantRules& rules, VariantTopology& topology, std::string& error);
+
+/**
+ * Reads a variant puzzle file: its rules and its givens. The file holds these sections, in any
+ * order. Blank lines are ignored, and so is everything from '#' to the end of a section line; the
+ * 9 rows that follow grid or regions only have their first 9 characters read:
+ *
+ *     diagonals                    both diagonals are units (X-Sudoku)
+ *     grid                         followed by 9 lines of 9 characters, as in a puzzle file
+ *     regions                      followed by 9 lines of 9 region labels (jigsaw)
+ *     cage <sum> r<row>c<col> ...  a killer cage with its cells, rows and columns from 1 to 9
+ *
+ * A puzzle without a grid has no givens, as usual for killer puzzles.
+ *
+ * @param path The file.
+ * @param rules Receives the rules; they are checked by compileVariantTopology.
+ * @param puzzle Receives the givens, 0 for empty cells.
+ * @param error Receives the reason the file cannot be read, with its line number.
+ * @return true if the file was read, false otherwise.
+ */
+bool readVariantFile(const std::string& path, VariantRules& rules, Board& puzzle, std::string& error);
+
+#endif
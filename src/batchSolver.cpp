@@ -0,0 +1,225 @@
+#include "batchSolver.hpp"
+#include "puzzleReader.hpp"
+#include "sudokuSolver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+BatchSolver::BatchSolver(unsigned threadCount, const std::string& engine, std::size_t chunkSize)
+    : threadCount(threadCount), engine(engine), chunkSize(chunkSize), solveCache(nullptr) {
+    if(this->threadCount == 0){
+        this->threadCount = std::thread::hardware_concurrency();
+    }
+    if(this->threadCount == 0){
+        // hardware_concurrency() may not know the core count
+        this->threadCount = 1;
+    }
+    if(this->chunkSize == 0){
+        this->chunkSize = 1;
+    }
+}
+
+unsigned BatchSolver::getThreadCount() const {
+    return threadCount;
+}
+
+void BatchSolver::setSolveCache(SolveCache* cache){
+    solveCache = cache;
+}
+
+/**
+ * Takes the next range of puzzles for a worker. The worker's own deque is used from the back,
+ * so it keeps working on neighbouring puzzles; other deques are robbed from the front, which
+ * takes the work their owners would reach last.
+ *
+ * @param queues The deques of all workers.
+ * @param worker The index of the calling worker.
+ * @param range Receives the half-open range of puzzle indices.
+ * @return true if a range was found, false once every deque is empty.
+ */
+bool BatchSolver::takeWork(std::vector<WorkQueue>& queues, unsigned worker, std::pair<std::size_t, std::size_t>& range){
+    {
+        WorkQueue& own = queues[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if(!own.ranges.empty()){
+            range = own.ranges.back();
+            own.ranges.pop_back();
+            return true;
+        }
+    }
+    // Visit the other workers starting from the next one, so thieves spread over different victims
+    for(std::size_t offset=1; offset<queues.size(); ++offset){
+        WorkQueue& victim = queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if(!victim.ranges.empty()){
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
+    }
+    // Nothing new is ever added once solving has started, so empty deques mean the batch is done
+    return false;
+}
+
+/**
+ * Worker loop: solves puzzles with one reused solver instance until no work is left.
+ * The count is kept locally and published once at the end, so workers never share a cache line while solving.
+ */
+void BatchSolver::runWorker(std::vector<WorkQueue>& queues, unsigned worker, const std::string& engine, SolveCache* solveCache,
+                            const std::vector<Board>& puzzles, std::vector<Board>& solutions, std::size_t& solved){
+    std::unique_ptr<SolverBackend> sudokuSolver = makeSolverBackend(engine);
+    SudokuSolver* ac3Solver = dynamic_cast<SudokuSolver*>(sudokuSolver.get());
+    if(ac3Solver != nullptr){
+        ac3Solver->setSolveCache(solveCache);
+    }
+    std::pair<std::size_t, std::size_t> range;
+    std::size_t solvedCount = 0;
+
+    while(takeWork(queues, worker, range)){
+        for(std::size_t i = range.first; i < range.second; ++i){
+            if(sudokuSolver->solve(puzzles[i])){
+                ++solvedCount;
+                sudokuSolver->writeBoard(solutions[i]);
+            } else {
+                // A partial board would look like a solution to whoever reads the output
+                solutions[i].fill(0);
+            }
+        }
+    }
+    solved = solvedCount;
+}
+
+/**
+ * Solves all puzzles in parallel. Solution i is the solved board of puzzle i; puzzles that have
+ * no solution get an empty board (every cell 0), like malformed lines in solveFile.
+ *
+ * @param puzzles The puzzles.
+ * @param solutions Receives the solutions in input order.
+ * @return Counts and wall-clock time for the batch.
+ */
+BatchSummary BatchSolver::solve(const std::vector<Board>& puzzles, std::vector<Board>& solutions){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    BatchSummary summary;
+    summary.puzzles = puzzles.size();
+    solutions.resize(puzzles.size());
+
+    // Deal contiguous blocks of chunks to the workers, so each starts on its own part of the input
+    std::vector<WorkQueue> queues(threadCount);
+    const std::size_t chunks = (puzzles.size() + chunkSize - 1) / chunkSize;
+    for(std::size_t chunk=0; chunk<chunks; ++chunk){
+        std::size_t first = chunk * chunkSize;
+        std::size_t last = std::min(first + chunkSize, puzzles.size());
+        queues[chunk * threadCount / chunks].ranges.emplace_back(first, last);
+    }
+
+    // Each worker counts into its own slot; the totals are summed once all of them have finished
+    std::vector<std::size_t> solved(threadCount, 0);
+    std::vector<std::thread> workers;
+    for(unsigned worker=1; worker<threadCount; ++worker){
+        workers.emplace_back(runWorker, std::ref(queues), worker, std::cref(engine), solveCache, std::cref(puzzles),
+                             std::ref(solutions), std::ref(solved[worker]));
+    }
+    // The calling thread works as well
+    runWorker(queues, 0, engine, solveCache, puzzles, solutions, solved[0]);
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+
+    for(unsigned worker=0; worker<threadCount; ++worker){
+        summary.solved += solved[worker];
+    }
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+// Number of malformed lines that are reported one by one; the rest are only counted
+static const std::size_t reportedMalformedLines = 10;
+
+/**
+ * Streams a puzzle file in the same format readBoard accepts, one 81-character puzzle per line,
+ * or in the packed format, and writes one solution per puzzle to the output file, in input order.
+ * The input is parsed straight into compact boards and solved in batches of streamBatchSize
+ * puzzles, so memory use stays flat however large it is. Empty text lines are skipped and a
+ * trailing '\r' is ignored; every other line that is not a puzzle is reported on stderr with its
+ * line number and byte offset, and written as an empty board so the output stays aligned with the
+ * input. Puzzles without a solution are written as an empty board as well.
+ *
+ * @param inputPath The puzzle file, or "-" for stdin.
+ * @param outputPath The solution file, or "-" for stdout.
+ * @param summary Receives the totals of the whole file.
+ * @param format Text lines or packed records for the solutions.
+ * @return true if the whole input was read and all solutions written, false otherwise.
+ */
+bool BatchSolver::solveFile(const std::string& inputPath, const std::string& outputPath, BatchSummary& summary,
+                            BoardWriter::Format format){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PuzzleReader reader;
+    if(!reader.open(inputPath)){
+        std::cerr << "Failed to open the puzzle file " << inputPath << "\n";
+        return false;
+    }
+    BoardWriter output;
+    if(!output.open(outputPath, format)){
+        std::cerr << "Failed to open the output file " << outputPath << "\n";
+        return false;
+    }
+
+    summary = BatchSummary();
+    const Board emptyBoard{};
+    std::vector<Board> puzzles;
+    puzzles.reserve(streamBatchSize);
+    // Output positions in the current batch that stand for malformed input lines
+    std::vector<std::size_t> malformedLines;
+    std::vector<Board> solutions;
+    Board board;
+    PuzzleReader::Status status = PuzzleReader::puzzleRead;
+    while(status != PuzzleReader::endOfInput){
+        puzzles.clear();
+        malformedLines.clear();
+        while(puzzles.size() + malformedLines.size() < streamBatchSize && (status = reader.next(board)) != PuzzleReader::endOfInput){
+            if(status == PuzzleReader::puzzleRead){
+                puzzles.push_back(board);
+                continue;
+            }
+            if(summary.malformed < reportedMalformedLines){
+                std::cerr << "Malformed puzzle on line " << reader.getLineNumber()
+                          << " (byte offset " << reader.getLineOffset() << ")\n";
+            }
+            malformedLines.push_back(puzzles.size() + malformedLines.size());
+            ++summary.malformed;
+        }
+        if(puzzles.empty() && malformedLines.empty()){
+            break;
+        }
+
+        summary.solved += solve(puzzles, solutions).solved;
+        summary.puzzles += puzzles.size() + malformedLines.size();
+        // Interleave the empty boards of malformed lines with the solutions
+        std::size_t written = 0;
+        for(std::size_t i=0; i<malformedLines.size(); ++i){
+            const std::size_t solvedBefore = malformedLines[i] - i;
+            output.write(solutions.data() + written, solvedBefore - written);
+            output.write(emptyBoard);
+            written = solvedBefore;
+        }
+        output.write(solutions.data() + written, puzzles.size() - written);
+    }
+    const bool written = output.close();
+    if(summary.malformed > reportedMalformedLines){
+        std::cerr << "... " << summary.malformed - reportedMalformedLines << " more malformed lines\n";
+    }
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if(reader.hasFailed()){
+        std::cerr << "Failed to read the puzzle file " << inputPath << "\n";
+        return false;
+    }
+    if(!written){
+        std::cerr << "Failed to write the output file " << outputPath << "\n";
+        return false;
+    }
+    return true;
+}
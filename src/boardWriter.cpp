@@ -0,0 +1,100 @@
+#include "boardWriter.hpp"
+#include "packedBoard.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Character of every cell value in text output
+static const char cellSymbols[16] = {'.', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', '.', '.', '.', '.', '.'};
+
+BoardWriter::BoardWriter() : descriptor(-1), format(textFormat), used(0), failed(false) {}
+
+BoardWriter::~BoardWriter(){
+    close();
+}
+
+/**
+ * Opens the output and, for the packed format, writes its header.
+ *
+ * @param path The file to write, or "-" for stdout.
+ * @param format The format of all boards written.
+ * @return true if the output could be opened, false otherwise.
+ */
+bool BoardWriter::open(const std::string& path, Format format){
+    close();
+    descriptor = path == "-" ? STDOUT_FILENO : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(descriptor < 0){
+        return false;
+    }
+    this->format = format;
+    buffer.resize(bufferSize);
+    used = 0;
+    failed = false;
+    if(format == packedFormat){
+        reserve(packedMagicSize);
+        std::copy(packedMagic, packedMagic + packedMagicSize, buffer.data() + used);
+        used += packedMagicSize;
+    }
+    return true;
+}
+
+// Writes the whole buffer, retrying short and interrupted writes.
+void BoardWriter::flush(){
+    std::size_t done = 0;
+    while(done < used && !failed){
+        const ssize_t count = ::write(descriptor, buffer.data() + done, used - done);
+        if(count > 0){
+            done += static_cast<std::size_t>(count);
+        } else if(count == 0 || errno != EINTR){
+            failed = true;
+        }
+    }
+    used = 0;
+}
+
+void BoardWriter::reserve(std::size_t count){
+    if(buffer.size() - used < count){
+        flush();
+    }
+}
+
+// Appends one board: 81 characters and a newline, or one packed record.
+void BoardWriter::write(const Board& board){
+    if(format == packedFormat){
+        reserve(packedBoardSize);
+        packBoard(board, reinterpret_cast<std::uint8_t*>(buffer.data() + used));
+        used += packedBoardSize;
+        return;
+    }
+    reserve(board.size() + 1);
+    char* out = buffer.data() + used;
+    for(std::size_t cell=0; cell<board.size(); ++cell){
+        out[cell] = cellSymbols[board[cell] & 0x0F];
+    }
+    out[board.size()] = '\n';
+    used += board.size() + 1;
+}
+
+void BoardWriter::write(const Board* boards, std::size_t count){
+    for(std::size_t i=0; i<count; ++i){
+        write(boards[i]);
+    }
+}
+
+/**
+ * Writes out the buffered boards and closes the output; stdout is flushed but left open.
+ *
+ * @return true if every board was written, false otherwise.
+ */
+bool BoardWriter::close(){
+    if(descriptor < 0){
+        return !failed;
+    }
+    flush();
+    if(descriptor != STDOUT_FILENO && ::close(descriptor) != 0){
+        failed = true;
+    }
+    descriptor = -1;
+    return !failed;
+}
@@ -0,0 +1,272 @@
+#include "canonicalForm.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Most partial symmetries, tied on the clue pattern so far, that are followed to the next row
+static const int maxPatternStates = 128;
+// Most complete symmetries whose relabeled boards are compared once the clue pattern is fixed
+static const int maxArrangements = 512;
+
+// Number of orderings of a run of up to three tied rows, columns or stacks
+static const int factorials[4] = {1, 1, 2, 6};
+
+/**
+ * A partial symmetry while the clue pattern is minimized: the source rows of the rows placed so far,
+ * and pattern keys that stand for every column arrangement giving those rows their smallest pattern.
+ * Columns are ordered within their stack by key and stacks by key; equal keys are still tied.
+ */
+struct PatternState {
+    std::array<std::uint8_t, 9> rows;
+    // Clues of every column of the orientation in the placed rows, the first row in the highest bit
+    std::array<std::uint16_t, 9> colKeys;
+    // Clue pattern of every stack in the placed rows, three bits per row, the first row highest
+    std::array<std::uint32_t, 3> stackKeys;
+    std::uint16_t usedRows;
+    bool transposed;
+};
+
+// Cell of the original board at a row and column of the chosen orientation.
+static inline int sourceCell(bool transposed, int row, int col){
+    return transposed ? col * 9 + row : row * 9 + col;
+}
+
+// Transforms the board cell by cell.
+void BoardSymmetry::apply(const Board& board, Board& transformed) const {
+    for(int row=0; row<9; ++row){
+        for(int col=0; col<9; ++col){
+            transformed[row * 9 + col] = labels[board[sourceCell(transposed, rows[row], cols[col])]];
+        }
+    }
+}
+
+// Puts every cell back in its original place with its original value.
+void BoardSymmetry::invert(const Board& transformed, Board& board) const {
+    std::array<std::uint8_t, 10> values{};
+    for(int value=0; value<=9; ++value){
+        values[labels[value]] = static_cast<std::uint8_t>(value);
+    }
+    for(int row=0; row<9; ++row){
+        for(int col=0; col<9; ++col){
+            board[sourceCell(transposed, rows[row], cols[col])] = values[transformed[row * 9 + col]];
+        }
+    }
+}
+
+// Sorts three keys without branches.
+template<typename Key>
+static inline void sortThree(Key& first, Key& second, Key& third){
+    const Key low = std::min(first, second);
+    const Key high = std::max(first, second);
+    const Key middle = std::min(high, third);
+    third = std::max(high, third);
+    first = std::min(low, middle);
+    second = std::max(low, middle);
+}
+
+/**
+ * Places the next row. The row's clues are appended to the column keys, so ordering the columns of
+ * a stack by key moves its empty cells to the front within every run of tied columns; the chunk of
+ * the row this leaves in each stack is appended to the stack keys, which orders tied stacks by it.
+ *
+ * @param state The partial symmetry to extend.
+ * @param rowBits The clues of the row, bit c set for a clue in column c of the orientation.
+ * @return The clue pattern of the row in the new arrangement, bit 8 for the first column.
+ */
+static int placeRow(PatternState& state, int rowBits){
+    std::array<std::uint32_t, 3> stackKeys;
+    for(int stack=0; stack<3; ++stack){
+        std::array<std::uint16_t, 3> keys;
+        for(int offset=0; offset<3; ++offset){
+            const int col = stack * 3 + offset;
+            keys[offset] = static_cast<std::uint16_t>(state.colKeys[col] << 1 | (rowBits >> col & 1));
+            state.colKeys[col] = keys[offset];
+        }
+        sortThree(keys[0], keys[1], keys[2]);
+        const std::uint32_t chunk = (keys[0] & 1) << 2 | (keys[1] & 1) << 1 | (keys[2] & 1);
+        state.stackKeys[stack] = state.stackKeys[stack] << 3 | chunk;
+        stackKeys[stack] = state.stackKeys[stack];
+    }
+    sortThree(stackKeys[0], stackKeys[1], stackKeys[2]);
+    return static_cast<int>((stackKeys[0] & 7) << 6 | (stackKeys[1] & 7) << 3 | (stackKeys[2] & 7));
+}
+
+// A run of tied entries whose orderings are all tried
+struct TiedRun {
+    std::uint8_t* first;
+    int length;
+};
+
+// Steps to the next ordering of the tied runs, like an odometer; false once all have been tried.
+static bool nextArrangement(TiedRun* runs, int runCount){
+    for(int run=0; run<runCount; ++run){
+        if(std::next_permutation(runs[run].first, runs[run].first + runs[run].length)){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Finds the canonical form in two steps. The clue pattern is minimized row by row: a row is
+ * chosen (which also chooses its band, at the start of one) and the columns are narrowed to the
+ * arrangements that make it smallest, keeping every row choice that ties. Most puzzles are left
+ * with a single symmetry; for the rest, every remaining ordering of tied columns and stacks that
+ * hold clues is relabeled and the smallest board wins.
+ *
+ * @param board The puzzle, 0 for empty cells.
+ * @param canonical Receives the canonical form.
+ * @param symmetry Receives a symmetry that turns the puzzle into its canonical form.
+ * @return false if the search would take too long, leaving canonical and symmetry unspecified.
+ */
+bool canonicalizeBoard(const Board& board, Board& canonical, BoardSymmetry& symmetry){
+    // Clue bits of every row in both orientations; the rows of one are the columns of the other
+    std::array<std::array<int, 9>, 2> rowBits{};
+    for(int row=0; row<9; ++row){
+        for(int col=0; col<9; ++col){
+            const int clue = board[row * 9 + col] != 0;
+            rowBits[0][row] |= clue << col;
+            rowBits[1][col] |= clue << row;
+        }
+    }
+
+    std::array<PatternState, maxPatternStates> states[2];
+    int current = 0;
+    int stateCount = 2;
+    for(int orientation=0; orientation<2; ++orientation){
+        PatternState& state = states[current][orientation];
+        state.colKeys.fill(0);
+        state.stackKeys.fill(0);
+        state.usedRows = 0;
+        state.transposed = orientation == 1;
+    }
+    for(int row=0; row<9; ++row){
+        const int next = 1 - current;
+        int nextCount = 0;
+        int best = 1 << 9;
+        for(int i=0; i<stateCount; ++i){
+            const PatternState& state = states[current][i];
+            for(int candidate=0; candidate<9; ++candidate){
+                if(state.usedRows >> candidate & 1){
+                    continue;
+                }
+                // A band is taken whole: its first row may come from any unused band, the others from the same band
+                const int band = candidate / 3;
+                if(row % 3 == 0 ? (state.usedRows >> (band * 3) & 7) != 0 : band != state.rows[row - 1] / 3){
+                    continue;
+                }
+                PatternState extended = state;
+                const int pattern = placeRow(extended, rowBits[state.transposed][candidate]);
+                if(pattern > best){
+                    continue;
+                }
+                if(pattern < best){
+                    best = pattern;
+                    nextCount = 0;
+                }
+                if(nextCount == maxPatternStates){
+                    return false;
+                }
+                extended.rows[row] = static_cast<std::uint8_t>(candidate);
+                extended.usedRows |= static_cast<std::uint16_t>(1 << candidate);
+                states[next][nextCount++] = extended;
+            }
+        }
+        current = next;
+        stateCount = nextCount;
+    }
+
+    // Relabel every remaining arrangement and keep the smallest board
+    bool found = false;
+    int arrangements = 0;
+    Board candidateBoard;
+    for(int i=0; i<stateCount; ++i){
+        const PatternState& state = states[current][i];
+        // Stacks ordered by key, and the columns of every stack by key; ties keep their index order
+        std::uint8_t slotOrder[3] = {0, 1, 2};
+        std::sort(slotOrder, slotOrder + 3, [&state](std::uint8_t first, std::uint8_t second){
+            return state.stackKeys[first] < state.stackKeys[second]
+                || (state.stackKeys[first] == state.stackKeys[second] && first < second);
+        });
+        std::uint8_t stackCols[3][3];
+        for(int stack=0; stack<3; ++stack){
+            for(int offset=0; offset<3; ++offset){
+                stackCols[stack][offset] = static_cast<std::uint8_t>(stack * 3 + offset);
+            }
+            std::sort(stackCols[stack], stackCols[stack] + 3, [&state](std::uint8_t first, std::uint8_t second){
+                return state.colKeys[first] < state.colKeys[second]
+                    || (state.colKeys[first] == state.colKeys[second] && first < second);
+            });
+        }
+        // Tied stacks and columns look the same, so only those holding clues need to be reordered
+        TiedRun runs[12];
+        int runCount = 0;
+        int orderings = 1;
+        for(int start=0; start<3; ){
+            int end = start + 1;
+            while(end < 3 && state.stackKeys[slotOrder[end]] == state.stackKeys[slotOrder[start]]){
+                ++end;
+            }
+            if(end - start > 1 && state.stackKeys[slotOrder[start]] != 0){
+                runs[runCount++] = TiedRun{slotOrder + start, end - start};
+                orderings *= factorials[end - start];
+            }
+            start = end;
+        }
+        for(int stack=0; stack<3; ++stack){
+            for(int start=0; start<3; ){
+                int end = start + 1;
+                while(end < 3 && state.colKeys[stackCols[stack][end]] == state.colKeys[stackCols[stack][start]]){
+                    ++end;
+                }
+                if(end - start > 1 && state.colKeys[stackCols[stack][start]] != 0){
+                    runs[runCount++] = TiedRun{stackCols[stack] + start, end - start};
+                    orderings *= factorials[end - start];
+                }
+                start = end;
+            }
+        }
+        arrangements += orderings;
+        if(arrangements > maxArrangements){
+            return false;
+        }
+
+        BoardSymmetry arrangement;
+        arrangement.transposed = state.transposed;
+        arrangement.rows = state.rows;
+        do {
+            for(int position=0; position<9; ++position){
+                arrangement.cols[position] = stackCols[slotOrder[position / 3]][position % 3];
+            }
+            // Relabel in order of first appearance, without branching on the values
+            arrangement.labels.fill(0);
+            std::uint8_t nextLabel = 1;
+            for(int row=0; row<9; ++row){
+                for(int col=0; col<9; ++col){
+                    const std::uint8_t value = board[sourceCell(state.transposed, state.rows[row], arrangement.cols[col])];
+                    const bool unlabeled = value != 0 && arrangement.labels[value] == 0;
+                    arrangement.labels[value] = unlabeled ? nextLabel : arrangement.labels[value];
+                    nextLabel += unlabeled;
+                    candidateBoard[row * 9 + col] = arrangement.labels[value];
+                }
+            }
+            if(!found || std::memcmp(candidateBoard.data(), canonical.data(), candidateBoard.size()) < 0){
+                canonical = candidateBoard;
+                symmetry = arrangement;
+                found = true;
+            }
+        } while(nextArrangement(runs, runCount));
+    }
+
+    // Values that are not on the board take the remaining labels, so the relabeling is a permutation
+    std::uint8_t nextLabel = 1;
+    for(int value=1; value<=9; ++value){
+        nextLabel = std::max<std::uint8_t>(nextLabel, symmetry.labels[value] + 1);
+    }
+    for(int value=1; value<=9; ++value){
+        if(symmetry.labels[value] == 0){
+            symmetry.labels[value] = nextLabel++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,249 @@
+#include "dlxSolver.hpp"
+
+/**
+ * Builds the exact cover matrix. Candidate row r = cell * 9 + (value - 1) covers the columns
+ * "cell is filled", "value in row", "value in column" and "value in block", in that order.
+ */
+DlxSolver::DlxSolver() {
+    // Column headers form a circular list around the root
+    for(int node=0; node<=columnCount; ++node){
+        left[node] = static_cast<short>(node == 0 ? columnCount : node - 1);
+        right[node] = static_cast<short>(node == columnCount ? 0 : node + 1);
+        up[node] = static_cast<short>(node);
+        down[node] = static_cast<short>(node);
+        column[node] = static_cast<short>(node);
+        candidate[node] = -1;
+        columnSize[node] = 0;
+        columnCovered[node] = false;
+    }
+
+    for(int row=0; row<rowCount; ++row){
+        const int cell = row / 9;
+        const int digit = row % 9;
+        const int block = (cell / 27) * 3 + (cell % 9) / 3;
+        const int columns[4] = {cell, 81 + (cell / 9) * 9 + digit, 162 + (cell % 9) * 9 + digit, 243 + block * 9 + digit};
+        const int first = 1 + columnCount + row * 4;
+        for(int k=0; k<4; ++k){
+            const int node = first + k;
+            const int header = 1 + columns[k];
+            // Link the four nodes of the row into a circle
+            left[node] = static_cast<short>(first + (k + 3) % 4);
+            right[node] = static_cast<short>(first + (k + 1) % 4);
+            // Append the node at the bottom of its column
+            up[node] = up[header];
+            down[node] = static_cast<short>(header);
+            down[up[header]] = static_cast<short>(node);
+            up[header] = static_cast<short>(node);
+            column[node] = static_cast<short>(header);
+            candidate[node] = static_cast<short>(row);
+            ++columnSize[header];
+        }
+    }
+    reset();
+}
+
+void DlxSolver::reset() {
+    givens.fill(0);
+    cellValues.fill(allCandidates);
+    givenCount = 0;
+    stats = SearchStats();
+}
+
+// Reads a Sudoku board from its compact form; the exact cover matrix itself is left untouched.
+void DlxSolver::readBoard(const Board& board) {
+    for(int cell=0; cell<81; ++cell){
+        int value = board[cell];
+        if(value >= 1 && value <= 9){
+            givens[cell] = static_cast<std::uint8_t>(value);
+            cellValues[cell] = candidateBit(value);
+        } else {
+            givens[cell] = 0;
+            cellValues[cell] = allCandidates;
+        }
+    }
+}
+
+const CellDomains& DlxSolver::getCellValues() const {
+    return cellValues;
+}
+
+const SearchStats& DlxSolver::getSearchStats() const {
+    return stats;
+}
+
+// Removes a column from the header list and every row that intersects it from the other columns.
+void DlxSolver::cover(int columnNode){
+    right[left[columnNode]] = right[columnNode];
+    left[right[columnNode]] = left[columnNode];
+    for(int i = down[columnNode]; i != columnNode; i = down[i]){
+        for(int j = right[i]; j != i; j = right[j]){
+            up[down[j]] = up[j];
+            down[up[j]] = down[j];
+            --columnSize[column[j]];
+        }
+    }
+    columnCovered[columnNode] = true;
+    ++stats.propagations;
+}
+
+// Exactly reverses cover(), relinking in the opposite order.
+void DlxSolver::uncover(int columnNode){
+    for(int i = up[columnNode]; i != columnNode; i = up[i]){
+        for(int j = left[i]; j != i; j = left[j]){
+            ++columnSize[column[j]];
+            up[down[j]] = static_cast<short>(j);
+            down[up[j]] = static_cast<short>(j);
+        }
+    }
+    right[left[columnNode]] = static_cast<short>(columnNode);
+    left[right[columnNode]] = static_cast<short>(columnNode);
+    columnCovered[columnNode] = false;
+}
+
+void DlxSolver::selectRow(int rowNode){
+    cover(column[rowNode]);
+    for(int j = right[rowNode]; j != rowNode; j = right[j]){
+        cover(column[j]);
+    }
+}
+
+void DlxSolver::deselectRow(int rowNode){
+    for(int j = left[rowNode]; j != rowNode; j = left[j]){
+        uncover(column[j]);
+    }
+    uncover(column[rowNode]);
+}
+
+/**
+ * Chooses the column with the fewest remaining rows (Knuth's S heuristic), the exact cover
+ * counterpart of the minimum remaining values heuristic.
+ *
+ * @return The header node of the chosen column.
+ */
+int DlxSolver::chooseColumn() const {
+    int best = right[root];
+    for(int node = right[best]; node != root && columnSize[best] > 1; node = right[node]){
+        if(columnSize[node] < columnSize[best]){
+            best = node;
+        }
+    }
+    return best;
+}
+
+void DlxSolver::recordSolution(int depth){
+    for(int level=0; level<depth; ++level){
+        const int row = candidate[searchStack[level]];
+        cellValues[row / 9] = candidateBit(row % 9 + 1);
+    }
+}
+
+/**
+ * Solves the board with Algorithm X.
+ *
+ * @return true if the puzzle is solved, false if it has no solution.
+ */
+bool DlxSolver::solve() {
+    return countSolutions(1) == 1;
+}
+
+/**
+ * Selects the rows of the givens, then runs Algorithm X iteratively over an explicit stack of chosen
+ * rows, carrying on past each solution until the limit is reached. Whatever the outcome, every cover
+ * is undone before returning, so the matrix is ready for the next puzzle.
+ *
+ * @param limit The count at which to stop searching; 0 searches the whole tree.
+ * @param solutions Optional list that receives every solution found.
+ * @return The number of solutions found, at most limit. The board holds the last one found, if any.
+ */
+std::size_t DlxSolver::countSolutions(std::size_t limit, std::vector<CellDomains>* solutions) {
+    givenCount = 0;
+    stats = SearchStats();
+    stats.nodes = 1;
+    bool consistent = true;
+    for(int cell=0; cell<81 && consistent; ++cell){
+        if(givens[cell] == 0){
+            continue;
+        }
+        const int rowNode = 1 + columnCount + (cell * 9 + givens[cell] - 1) * 4;
+        // A given whose constraint is already covered clashes with an earlier given
+        for(int k=0; k<4; ++k){
+            if(columnCovered[column[rowNode + k]]){
+                consistent = false;
+            }
+        }
+        if(consistent){
+            selectRow(rowNode);
+            givenRows[givenCount++] = static_cast<short>(rowNode);
+        }
+    }
+
+    std::size_t count = 0;
+    bool stopped = false;
+    int depth = 0;
+    bool descend = consistent;
+    while(consistent){
+        if(descend){
+            if(right[root] == root){
+                recordSolution(depth);
+                ++count;
+                if(solutions != nullptr){
+                    solutions->push_back(cellValues);
+                }
+                if(count == limit){
+                    stopped = true;
+                    break;
+                }
+                // Carry on with the next row of the deepest level
+                if(depth == 0){
+                    break;
+                }
+                --depth;
+                descend = false;
+                continue;
+            }
+            const int header = chooseColumn();
+            if(columnSize[header] > 1){
+                ++stats.guesses;
+            }
+            cover(header);
+            searchStack[depth] = down[header];
+        } else {
+            // Undo the row tried on this level and move on to the next one
+            const int rowNode = searchStack[depth];
+            for(int j = left[rowNode]; j != rowNode; j = left[j]){
+                uncover(column[j]);
+            }
+            searchStack[depth] = down[rowNode];
+        }
+
+        const int rowNode = searchStack[depth];
+        const int header = column[rowNode];
+        if(rowNode == header){
+            // Every row of this column failed
+            uncover(header);
+            if(depth == 0){
+                break;
+            }
+            --depth;
+            descend = false;
+            continue;
+        }
+        for(int j = right[rowNode]; j != rowNode; j = right[j]){
+            cover(column[j]);
+        }
+        ++stats.nodes;
+        ++depth;
+        descend = true;
+    }
+
+    // Unwind the path of the solution the search stopped at, then the givens
+    if(stopped){
+        for(int level = depth - 1; level >= 0; --level){
+            deselectRow(searchStack[level]);
+        }
+    }
+    while(givenCount > 0){
+        deselectRow(givenRows[--givenCount]);
+    }
+    return count;
+}
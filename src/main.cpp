@@ -1,22 +1,373 @@
 #include "sudokuSolver.hpp"
+#include "batchSolver.hpp"
+#include "parallelSearch.hpp"
+#include "puzzleReader.hpp"
+#include "boardWriter.hpp"
+#include "solveCache.hpp"
+#include "puzzleGenerator.hpp"
+#include "solverService.hpp"
+#include "variantSolver.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
-#include "time.h"
-
-int main() {
-    
-    SudokuSolver sudokuSolver;
-    sudokuSolver.welcomeMessage();
-    if(sudokuSolver.readBoardFromFiles()){
-        
-        clock_t a,b;
-        a=clock();
-        sudokuSolver.inferAC3Guessing();
-        b=clock();
-        
-        sudokuSolver.printStatus();
-        std::cout << "Puzzle solved. Time took: " << double(b)/CLOCKS_PER_SEC << "s" << std::endl;
-    }
-    sudokuSolver.endMessage();
+#include <memory>
+#include <string>
+
+// Wall-clock seconds since the given start; CPU time would add up the threads of a parallel search
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Prints the detailed statistics of the AC-3 solver, which are only collected when built with SUDOKU_STATS.
+static void printSolverStats(const SolverStats& stats) {
+    if(!solverStatsEnabled){
+        return;
+    }
+    std::cout << "Arcs processed: " << stats.arcsProcessed << ", elimination kernel runs: " << stats.kernelRuns
+              << ", values removed: " << stats.valuesRemoved << ", hidden singles: " << stats.hiddenSingles << "\n"
+              << "Rollbacks: " << stats.rollbacks << ", max depth: " << stats.maxDepth << "\n"
+              << "Seconds in initial propagation: " << stats.phaseSeconds[initialPropagationPhase]
+              << ", guess propagation: " << stats.phaseSeconds[guessPropagationPhase]
+              << ", guess selection: " << stats.phaseSeconds[guessSelectionPhase]
+              << ", rollback: " << stats.phaseSeconds[rollbackPhase] << std::endl;
+}
+
+// Solves a whole file of puzzles: SudokuSolver --batch <input> <output> [--threads N] [--engine NAME] [--packed] [--cache N]
+static int runBatch(const std::string& input, const std::string& output, unsigned threads, const std::string& engine,
+                    BoardWriter::Format format, std::size_t cacheSize) {
+    BatchSolver batchSolver(threads, engine);
+    std::unique_ptr<SolveCache> solveCache;
+    if(cacheSize != 0){
+        solveCache.reset(new SolveCache(cacheSize));
+        batchSolver.setSolveCache(solveCache.get());
+    }
+    BatchSummary summary;
+    if(!batchSolver.solveFile(input, output, summary, format)){
+        return 1;
+    }
+
+    std::cerr << "Solved " << summary.solved << " of " << summary.puzzles << " puzzles";
+    if(summary.malformed != 0){
+        std::cerr << " (" << summary.malformed << " malformed)";
+    }
+    std::cerr << " on " << batchSolver.getThreadCount() << " threads in " << summary.seconds << "s, "
+              << summary.puzzles / summary.seconds << " puzzles/s\n";
+    if(solveCache){
+        std::cerr << "Solve cache: " << solveCache->getHits() << " hits, " << solveCache->getMisses() << " misses\n";
+    }
+    return 0;
+}
+
+// Rewrites a puzzle file in another format without solving it: SudokuSolver --convert <input> <output> [--packed].
+// Malformed lines are dropped.
+static int runConvert(const std::string& input, const std::string& output, BoardWriter::Format format) {
+    PuzzleReader reader;
+    BoardWriter writer;
+    if(!reader.open(input)){
+        std::cerr << "Failed to open the puzzle file " << input << "\n";
+        return 1;
+    }
+    if(!writer.open(output, format)){
+        std::cerr << "Failed to open the output file " << output << "\n";
+        return 1;
+    }
+    Board board;
+    std::size_t converted = 0;
+    std::size_t malformed = 0;
+    PuzzleReader::Status status;
+    while((status = reader.next(board)) != PuzzleReader::endOfInput){
+        if(status == PuzzleReader::puzzleRead){
+            writer.write(board);
+            ++converted;
+        } else {
+            ++malformed;
+        }
+    }
+    if(!writer.close() || reader.hasFailed()){
+        std::cerr << "Failed to convert " << input << "\n";
+        return 1;
+    }
+    std::cerr << "Converted " << converted << " puzzles, skipped " << malformed << " malformed lines\n";
+    return 0;
+}
+
+// Generates graded puzzles with a unique solution:
+// SudokuSolver --generate <count> <output> [--difficulty easy|medium|hard|expert] [--seed S] [--threads N] [--packed]
+static int runGenerate(std::size_t count, const std::string& output, unsigned threads, std::uint64_t seed,
+                       const PuzzleDifficulty* difficulty, BoardWriter::Format format) {
+    BoardWriter writer;
+    if(!writer.open(output, format)){
+        std::cerr << "Failed to open the output file " << output << "\n";
+        return 1;
+    }
+    PuzzleGenerator generator(threads, seed);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::vector<GeneratedPuzzle> puzzles = generator.generate(count, difficulty);
+    const double seconds = secondsSince(start);
+
+    std::size_t graded[puzzleDifficultyCount] = {};
+    for(const GeneratedPuzzle& generated : puzzles){
+        writer.write(generated.puzzle);
+        ++graded[generated.grade.difficulty];
+    }
+    if(!writer.close()){
+        std::cerr << "Failed to write " << output << "\n";
+        return 1;
+    }
+    std::cerr << "Generated " << puzzles.size() << " puzzles on " << generator.getThreadCount() << " threads in "
+              << seconds << "s, " << puzzles.size() / seconds << " puzzles/s\n";
+    for(int level=0; level<puzzleDifficultyCount; ++level){
+        std::cerr << (level == 0 ? "" : ", ") << difficultyName(static_cast<PuzzleDifficulty>(level)) << ": " << graded[level];
+    }
+    std::cerr << "\n";
+    return 0;
+}
+
+// The running service, stopped by SIGINT and SIGTERM
+static SolverService* runningService = nullptr;
+
+static void stopService(int) {
+    if(runningService != nullptr){
+        runningService->stop();
+    }
+}
+
+// Serves puzzles over a socket until interrupted: SudokuSolver --serve <address> [--threads N] [--engine NAME] [--cache N]
+static int runService(const std::string& address, unsigned threads, const std::string& engine, std::size_t cacheSize) {
+    SolverService service(threads, engine);
+    std::unique_ptr<SolveCache> solveCache;
+    if(cacheSize != 0){
+        solveCache.reset(new SolveCache(cacheSize));
+        service.setSolveCache(solveCache.get());
+    }
+    if(!service.open(address)){
+        return 1;
+    }
+    runningService = &service;
+    struct sigaction action{};
+    action.sa_handler = stopService;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::cerr << "Serving on " << service.getAddress() << " with " << service.getThreadCount() << " workers\n";
+    service.run();
+    runningService = nullptr;
+
+    const ServiceMetrics metrics = service.getMetrics();
+    std::cerr << "Answered " << metrics.solved + metrics.unsolvable << " of " << metrics.requests << " puzzles ("
+              << metrics.malformed << " malformed) in " << metrics.batches << " batches, latency mean "
+              << metrics.meanMicros << "us, p50 " << metrics.p50Micros << "us, p99 " << metrics.p99Micros
+              << "us, max " << metrics.maxMicros << "us, max queue depth " << metrics.maxQueueDepth << "\n";
+    return 0;
+}
+
+// Solves an X-Sudoku, jigsaw or killer puzzle described by a variant file: SudokuSolver --variant <file>.
+// The solution count shows whether the puzzle is proper (exactly one solution).
+static int runVariant(const std::string& path) {
+    VariantRules rules;
+    Board puzzle;
+    std::string error;
+    VariantTopology topology;
+    if(!readVariantFile(path, rules, puzzle, error) || !compileVariantTopology(rules, topology, error)){
+        std::cerr << error << "\n";
+        return 1;
+    }
+    VariantSolver variantSolver(topology);
+    variantSolver.readBoard(puzzle);
+    variantSolver.printStatus();
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::size_t solutions = variantSolver.countSolutions(2);
+    const double seconds = secondsSince(start);
+
+    variantSolver.printStatus();
+    if(solutions == 0){
+        std::cout << "The puzzle has no solution." << std::endl;
+        return 1;
+    }
+    std::cout << (solutions == 1 ? "Puzzle solved" : "Puzzle solved, but it has more than one solution")
+              << ". Time took: " << seconds << "s, search nodes: " << variantSolver.getSearchStats().nodes << std::endl;
+    return 0;
+}
+
+// Solves a puzzle of another board size interactively: SudokuSolver --order N (2 to 6).
+// Only the AC-3 engine is templated on the board size; main rejects the other engines for these boards.
+template<int Order>
+static int runInteractive(bool parallel, unsigned threads) {
+    // Larger boards need more working storage than a thread stack should hold
+    std::unique_ptr<BasicSudokuSolver<Order>> sudokuSolver(new BasicSudokuSolver<Order>());
+    sudokuSolver->welcomeMessage();
+    if(sudokuSolver->readBoardFromFiles()){
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool solved;
+        if(parallel){
+            BasicParallelSearch<Order> parallelSearch(threads);
+            solved = parallelSearch.solve(*sudokuSolver);
+        } else {
+            solved = sudokuSolver->solve();
+        }
+        const double seconds = secondsSince(start);
+
+        sudokuSolver->printStatus();
+        if(solved){
+            std::cout << "Puzzle solved. Time took: " << seconds << "s" << std::endl;
+        } else {
+            std::cout << "The puzzle has no solution." << std::endl;
+        }
+        // The workers of a parallel search keep their own statistics
+        if(!parallel){
+            printSolverStats(sudokuSolver->getSolverStats());
+        }
+    }
+    sudokuSolver->endMessage();
+    return 0;
+}
+
+static int printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--engine ac3|dlx|variant] [--parallel [N]] [--order 2-6]   (--parallel and --order need ac3)\n"
+              << "       " << program << " --batch <puzzle file> <solution file> [--threads N] [--engine ac3|dlx|variant] [--packed] [--cache N]\n"
+              << "       " << program << " --convert <puzzle file> <output file> [--packed]\n"
+              << "       " << program << " --generate <count> <output file> [--difficulty easy|medium|hard|expert] [--seed S] [--threads N] [--packed]\n"
+              << "       " << program << " --serve <unix:path | [host:]port> [--threads N] [--engine ac3|dlx|variant] [--cache N]\n"
+              << "       " << program << " --variant <variant file>\n";
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+
+    std::string engine = "ac3";
+    std::string batchInput, batchOutput;
+    bool batch = false;
+    // --convert only rewrites the puzzles; --packed writes the packed binary format instead of text
+    bool convert = false;
+    BoardWriter::Format format = BoardWriter::textFormat;
+    // --cache N keeps the solutions of up to N canonical puzzles in batch mode
+    std::size_t cacheSize = 0;
+    // --generate writes count new puzzles, of one difficulty if --difficulty is given
+    bool generate = false;
+    std::size_t generateCount = 0;
+    bool filterDifficulty = false;
+    PuzzleDifficulty difficulty = easyPuzzle;
+    std::uint64_t seed = 0;
+    // --serve runs the solver as a service on a socket
+    bool serve = false;
+    std::string serveAddress;
+    // --variant solves a puzzle file with variant rules (diagonals, jigsaw regions, killer cages)
+    std::string variantFile;
+    // --parallel [N] searches the puzzle on all cores (or N threads)
+    bool parallel = false;
+    unsigned threads = 0;
+    // Box order of the board: 3 for 9x9, 2 for 4x4, 4 for 16x16, 5 for 25x25, 6 for 36x36
+    int order = 3;
+    for(int i=1; i<argc; ++i){
+        std::string option = argv[i];
+        if(option == "--batch" && i + 2 < argc){
+            batch = true;
+            batchInput = argv[++i];
+            batchOutput = argv[++i];
+        } else if(option == "--convert" && i + 2 < argc){
+            convert = true;
+            batchInput = argv[++i];
+            batchOutput = argv[++i];
+        } else if(option == "--generate" && i + 2 < argc){
+            generate = true;
+            generateCount = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+            batchOutput = argv[++i];
+        } else if(option == "--serve" && i + 1 < argc){
+            serve = true;
+            serveAddress = argv[++i];
+        } else if(option == "--variant" && i + 1 < argc){
+            variantFile = argv[++i];
+        } else if(option == "--difficulty" && i + 1 < argc){
+            filterDifficulty = true;
+            if(!parseDifficulty(argv[++i], difficulty)){
+                return printUsage(argv[0]);
+            }
+        } else if(option == "--seed" && i + 1 < argc){
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if(option == "--cache" && i + 1 < argc){
+            cacheSize = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if(option == "--packed"){
+            format = BoardWriter::packedFormat;
+        } else if(option == "--threads" && i + 1 < argc){
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if(option == "--engine" && i + 1 < argc){
+            engine = argv[++i];
+        } else if(option == "--order" && i + 1 < argc){
+            order = std::atoi(argv[++i]);
+        } else if(option == "--parallel"){
+            parallel = true;
+            if(i + 1 < argc && argv[i + 1][0] != '-'){
+                threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            }
+        } else {
+            return printUsage(argv[0]);
+        }
+    }
+
+    std::unique_ptr<SolverBackend> sudokuSolver = makeSolverBackend(engine);
+    if(!sudokuSolver){
+        std::cerr << "Unknown engine '" << engine << "'\n";
+        return printUsage(argv[0]);
+    }
+    if(!variantFile.empty()){
+        return runVariant(variantFile);
+    }
+    if(convert){
+        return runConvert(batchInput, batchOutput, format);
+    }
+    if(serve){
+        return runService(serveAddress, threads, engine, cacheSize);
+    }
+    if(generate){
+        return runGenerate(generateCount, batchOutput, threads, seed, filterDifficulty ? &difficulty : nullptr, format);
+    }
+    if(batch){
+        return runBatch(batchInput, batchOutput, threads, engine, format, cacheSize);
+    }
+    // The parallel search and the other board sizes are built on the AC-3 solver
+    if(engine != "ac3" && (parallel || order != 3)){
+        std::cerr << (parallel ? "--parallel" : "--order") << " needs the ac3 engine\n";
+        return printUsage(argv[0]);
+    }
+    switch(order){
+        case 2: return runInteractive<2>(parallel, threads);
+        case 3: break;
+        case 4: return runInteractive<4>(parallel, threads);
+        case 5: return runInteractive<5>(parallel, threads);
+        case 6: return runInteractive<6>(parallel, threads);
+        default: return printUsage(argv[0]);
+    }
+
+    sudokuSolver->welcomeMessage();
+    if(sudokuSolver->readBoardFromFiles()){
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        // The parallel search splits the backtracking tree of the AC-3 solver, the only engine it accepts
+        SudokuSolver* ac3Solver = dynamic_cast<SudokuSolver*>(sudokuSolver.get());
+        bool solved;
+        if(parallel && ac3Solver != nullptr){
+            ParallelSearch parallelSearch(threads);
+            solved = parallelSearch.solve(*ac3Solver);
+        } else {
+            solved = sudokuSolver->solve();
+        }
+        const double seconds = secondsSince(start);
+
+        sudokuSolver->printStatus();
+        if(solved){
+            std::cout << "Puzzle solved. Time took: " << seconds << "s" << std::endl;
+        } else {
+            std::cout << "The puzzle has no solution." << std::endl;
+        }
+        // The workers of a parallel search keep their own statistics
+        if(!parallel && ac3Solver != nullptr){
+            printSolverStats(ac3Solver->getSolverStats());
+        }
+    }
+    sudokuSolver->endMessage();
 
     return 0;
 }
@@ -0,0 +1,117 @@
+#include "parallelSearch.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+template<int Order>
+BasicParallelSearch<Order>::BasicParallelSearch(unsigned threadCount) : threadCount(threadCount), found(false), idleWorkers(0), queuedTasks(0) {
+    if(this->threadCount == 0){
+        this->threadCount = std::thread::hardware_concurrency();
+    }
+    if(this->threadCount == 0){
+        // hardware_concurrency() may not know the core count
+        this->threadCount = 1;
+    }
+}
+
+template<int Order>
+unsigned BasicParallelSearch<Order>::getThreadCount() const {
+    return threadCount;
+}
+
+template<int Order>
+bool BasicParallelSearch<Order>::isCancelled() const {
+    return found.load(std::memory_order_relaxed);
+}
+
+// Work is only split off while someone is waiting and nothing is queued, so busy workers stay busy
+template<int Order>
+bool BasicParallelSearch<Order>::wantsWork() const {
+    return idleWorkers.load(std::memory_order_relaxed) != 0 && queuedTasks.load(std::memory_order_relaxed) == 0;
+}
+
+template<int Order>
+void BasicParallelSearch<Order>::shareWork(const Domains& cells){
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(cells);
+        ++queuedTasks;
+    }
+    workAvailable.notify_one();
+}
+
+/**
+ * Worker loop. Each worker owns one solver and keeps taking shared boards until one of the workers
+ * finds a solution, or until every worker is idle with an empty queue, which means the whole search
+ * tree has been explored without finding one.
+ */
+template<int Order>
+void BasicParallelSearch<Order>::runWorker(){
+    // Larger boards need more working storage than a thread stack should hold
+    std::unique_ptr<BasicSudokuSolver<Order>> sudokuSolver(new BasicSudokuSolver<Order>());
+
+    while(true){
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ++idleWorkers;
+            workAvailable.wait(guard, [this]{
+                return found || !tasks.empty() || idleWorkers == threadCount;
+            });
+            if(found || tasks.empty()){
+                // Wake the other idle workers so they can see that the search is over
+                workAvailable.notify_all();
+                return;
+            }
+            sudokuSolver->loadCellValues(tasks.front());
+            tasks.pop_front();
+            --queuedTasks;
+            --idleWorkers;
+        }
+
+        if(sudokuSolver->inferAC3Guessing(this)){
+            std::lock_guard<std::mutex> guard(lock);
+            if(!found){
+                solution = sudokuSolver->getCellValues();
+                found = true;
+            }
+            workAvailable.notify_all();
+            return;
+        }
+    }
+}
+
+/**
+ * Searches the board currently loaded in the given solver with all worker threads.
+ *
+ * @param sudokuSolver Holds the puzzle; receives the solution if one is found.
+ * @return true if the puzzle is solved, false if no solution exists.
+ */
+template<int Order>
+bool BasicParallelSearch<Order>::solve(BasicSudokuSolver<Order>& sudokuSolver){
+    tasks.clear();
+    tasks.push_back(sudokuSolver.getCellValues());
+    queuedTasks = 1;
+    idleWorkers = 0;
+    found = false;
+
+    std::vector<std::thread> workers;
+    for(unsigned worker=1; worker<threadCount; ++worker){
+        workers.emplace_back(&BasicParallelSearch<Order>::runWorker, this);
+    }
+    // The calling thread works as well
+    runWorker();
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+
+    if(found){
+        sudokuSolver.loadCellValues(solution);
+    }
+    return found;
+}
+
+template class BasicParallelSearch<2>;
+template class BasicParallelSearch<3>;
+template class BasicParallelSearch<4>;
+template class BasicParallelSearch<5>;
+template class BasicParallelSearch<6>;
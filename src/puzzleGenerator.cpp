@@ -0,0 +1,356 @@
+#include "puzzleGenerator.hpp"
+#include "eliminationKernel.hpp"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+
+// Most guesses a puzzle may need to be graded hard rather than expert. Minimal puzzles that need a
+// search mostly take one or two guesses; about a quarter of them take more
+static const std::uint64_t hardGuessLimit = 2;
+
+// Branching of the grading search, fixed so that grades do not shift when the solver's default changes
+static const BranchingStrategy gradingBranching = {minimumRemainingValues, ascendingValues};
+
+static const char* const difficultyNames[puzzleDifficultyCount] = {"easy", "medium", "hard", "expert"};
+
+const char* difficultyName(PuzzleDifficulty difficulty){
+    return difficultyNames[difficulty];
+}
+
+bool parseDifficulty(const std::string& name, PuzzleDifficulty& difficulty){
+    for(int level=0; level<puzzleDifficultyCount; ++level){
+        if(name == difficultyNames[level]){
+            difficulty = static_cast<PuzzleDifficulty>(level);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Seed of one attempt at one puzzle, mixed so that neighbouring indices give unrelated streams.
+static std::uint64_t attemptSeed(std::uint64_t seed, std::size_t index, std::uint64_t attempt){
+    std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(index) * 0x9E3779B97F4A7C15ull) ^ (attempt << 48);
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+// Number of cells of a board with more than one candidate left.
+static int openCells(const CellDomains& cells){
+    int open = 0;
+    for(CandidateMask values : cells){
+        open += countCandidates(values) > 1;
+    }
+    return open;
+}
+
+PuzzleGenerator::PuzzleGenerator(unsigned threadCount, std::uint64_t seed)
+    : threadCount(threadCount), seed(seed) {
+    if(this->threadCount == 0){
+        this->threadCount = std::thread::hardware_concurrency();
+    }
+    if(this->threadCount == 0){
+        // hardware_concurrency() may not know the core count
+        this->threadCount = 1;
+    }
+}
+
+unsigned PuzzleGenerator::getThreadCount() const {
+    return threadCount;
+}
+
+/**
+ * Applies naked and hidden singles until neither finds anything: the elimination kernel removes
+ * the values of solved cells from their peers, then every unit places the values that fit only
+ * one of its cells.
+ *
+ * @param cells The candidate masks of all cells, narrowed in place.
+ * @return false on a contradiction, true otherwise.
+ */
+static bool applySingles(CellDomains& cells){
+    while(true){
+        if(!eliminationKernel()(cells)){
+            return false;
+        }
+        bool placed = false;
+        for(const std::array<CellId, 9>& unit : sudokuTopology.units){
+            CandidateMask once = 0;
+            CandidateMask twice = 0;
+            // Values of the unit's solved cells, which are trivially in one place
+            CandidateMask solved = 0;
+            for(CellId cell : unit){
+                const CandidateMask values = cells[cell];
+                twice |= once & values;
+                once |= values;
+                solved |= (values & (values - 1)) == 0 ? values : 0;
+            }
+            if(once != allCandidates){
+                return false;
+            }
+            // Two hidden singles in one cell leave the second value without a place, which the next round finds
+            for(CandidateMask hidden = once & ~twice & ~solved; hidden != 0; hidden &= hidden - 1){
+                const CandidateMask bit = hidden & -hidden;
+                for(CellId cell : unit){
+                    if(cells[cell] & bit){
+                        placed = placed || cells[cell] != bit;
+                        cells[cell] = bit;
+                        break;
+                    }
+                }
+            }
+        }
+        if(!placed){
+            return true;
+        }
+    }
+}
+
+/**
+ * Searches for a solution with singles only, copying the board at every guess instead of keeping
+ * a trail. The uniqueness checks only need to know whether a solution exists, which this finds
+ * several times faster than the full propagation engine, whose rules cost more per node than they
+ * save on the easy boards left after a clue is removed.
+ *
+ * @param cells The candidate masks of all cells; receives the solution if there is one.
+ * @param random Picks the order in which the values of a guess are tried, or nullptr for smallest first.
+ * @param preferred Values to try before the others at every guess, or nullptr.
+ * @return true if a solution was found, false if there is none.
+ */
+static bool searchSingles(CellDomains& cells, std::mt19937_64* random, const Board* preferred){
+    // One guess level: the board before the guess, the guessed cell and its values not tried yet
+    struct SinglesFrame {
+        CellDomains cells;
+        CandidateMask untried;
+        std::uint8_t cell;
+    };
+    std::array<SinglesFrame, 81> searchStack;
+    int depth = 0;
+    bool consistent = applySingles(cells);
+    while(true){
+        if(consistent){
+            // Guess on the open cell with the fewest candidates; none left means solved
+            int guessCell = -1;
+            int fewest = 10;
+            for(int cell=0; cell<81 && fewest > 2; ++cell){
+                const int size = countCandidates(cells[cell]);
+                if(size > 1 && size < fewest){
+                    guessCell = cell;
+                    fewest = size;
+                }
+            }
+            if(guessCell < 0){
+                return true;
+            }
+            searchStack[depth++] = SinglesFrame{cells, cells[guessCell], static_cast<std::uint8_t>(guessCell)};
+        }
+        while(true){
+            if(depth == 0){
+                return false;
+            }
+            SinglesFrame& frame = searchStack[depth - 1];
+            if(frame.untried == 0){
+                --depth;
+                continue;
+            }
+            // The preferred value first, otherwise drop a random number of the smallest untried values and take the smallest left
+            CandidateMask options = frame.untried;
+            if(preferred != nullptr && (options & candidateBit((*preferred)[frame.cell]))){
+                options = candidateBit((*preferred)[frame.cell]);
+            } else if(random != nullptr){
+                for(int skip = static_cast<int>((*random)() % countCandidates(options)); skip > 0; --skip){
+                    options &= options - 1;
+                }
+            }
+            const CandidateMask guess = options & -options;
+            frame.untried &= ~guess;
+            cells = frame.cells;
+            cells[frame.cell] = guess;
+            break;
+        }
+        consistent = applySingles(cells);
+    }
+}
+
+/**
+ * Fills a random full grid. The diagonal blocks share no row, column or block, so any values in
+ * them can be completed; a search that tries the values of every guess in random order fills in
+ * the other six blocks.
+ *
+ * @param random The random stream of the puzzle.
+ * @param grid Receives the full grid.
+ */
+void PuzzleGenerator::randomGrid(std::mt19937_64& random, Board& grid){
+    CellDomains cells;
+    cells.fill(allCandidates);
+    std::array<std::uint8_t, 9> values = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for(int block=0; block<3; ++block){
+        std::shuffle(values.begin(), values.end(), random);
+        for(int offset=0; offset<9; ++offset){
+            cells[(block * 3 + offset / 3) * 9 + block * 3 + offset % 3] = candidateBit(values[offset]);
+        }
+    }
+    searchSingles(cells, &random, nullptr);
+    for(int cell=0; cell<81; ++cell){
+        grid[cell] = static_cast<std::uint8_t>(firstCandidate(cells[cell]));
+    }
+}
+
+/**
+ * Removes clues one at a time in random order. A clue can go if no solution of the remaining
+ * puzzle has another value in its cell: the cell keeps every candidate but its own value, and
+ * a search that finds no solution proves the rest of the grid still forces the clue. While many
+ * clues are left, naked singles alone settle this. Clues that cannot go are put back, so the
+ * puzzle ends up minimal.
+ *
+ * Minimal puzzles are rarely easy. When easy puzzles are asked for, a clue only goes if naked
+ * singles still solve the puzzle without it, which leaves the puzzle minimal among easy ones.
+ *
+ * @param random The random stream of the puzzle.
+ * @param grid The full grid.
+ * @param nakedSinglesOnly Whether naked singles must keep solving the puzzle.
+ * @param puzzle Receives the puzzle.
+ */
+void PuzzleGenerator::removeClues(std::mt19937_64& random, const Board& grid, bool nakedSinglesOnly, Board& puzzle){
+    std::array<std::uint8_t, 81> order;
+    for(int cell=0; cell<81; ++cell){
+        order[cell] = static_cast<std::uint8_t>(cell);
+    }
+    std::shuffle(order.begin(), order.end(), random);
+
+    puzzle = grid;
+    CellDomains cells;
+    for(int cell=0; cell<81; ++cell){
+        cells[cell] = candidateBit(grid[cell]);
+    }
+    for(std::uint8_t cell : order){
+        bool removable;
+        if(nakedSinglesOnly){
+            // Naked singles are sound, so a puzzle they finish has a unique solution
+            CellDomains reduced = cells;
+            reduced[cell] = allCandidates;
+            removable = eliminationKernel()(reduced) && openCells(reduced) == 0;
+        } else {
+            // Removed clues are open again, and this one may take anything but its own value
+            CellDomains other = cells;
+            other[cell] = allCandidates & ~candidateBit(grid[cell]);
+            removable = !searchSingles(other, nullptr, &grid);
+        }
+        if(removable){
+            cells[cell] = allCandidates;
+            puzzle[cell] = 0;
+        }
+    }
+}
+
+/**
+ * Grades a puzzle by how far each level of the solver gets on it: naked singles alone (the
+ * elimination kernel, which is what AC-3 amounts to), the full propagation engine of
+ * inferAC3Improved, and finally the search, whose guesses separate hard from expert puzzles. The
+ * search always branches with gradingBranching; the solver's own strategy is restored afterwards.
+ *
+ * @param sudokuSolver The solver used for grading.
+ * @param puzzle A puzzle with a unique solution.
+ * @return The grade, with the counters it was based on.
+ */
+PuzzleGrade PuzzleGenerator::grade(SudokuSolver& sudokuSolver, const Board& puzzle){
+    PuzzleGrade grade;
+    CellDomains cells;
+    for(int cell=0; cell<81; ++cell){
+        cells[cell] = puzzle[cell] != 0 ? candidateBit(puzzle[cell]) : allCandidates;
+    }
+    eliminationKernel()(cells);
+    grade.openAfterElimination = openCells(cells);
+    // Every level that finishes the puzzle leaves the search a single node
+    grade.nodes = 1;
+    if(grade.openAfterElimination == 0){
+        grade.difficulty = easyPuzzle;
+        return grade;
+    }
+
+    // Propagation carries on from where naked singles stopped
+    sudokuSolver.loadCellValues(cells);
+    sudokuSolver.inferAC3Improved();
+    grade.openAfterPropagation = openCells(sudokuSolver.getCellValues());
+    if(grade.openAfterPropagation == 0){
+        grade.difficulty = mediumPuzzle;
+        return grade;
+    }
+
+    // The search starts from the propagated board, which its own first propagation leaves as it is
+    const BranchingStrategy branching = sudokuSolver.getBranching();
+    sudokuSolver.setBranching(gradingBranching);
+    sudokuSolver.inferAC3Guessing();
+    sudokuSolver.setBranching(branching);
+    const SearchStats& stats = sudokuSolver.getSearchStats();
+    grade.guesses = stats.guesses;
+    grade.nodes = stats.nodes;
+    grade.difficulty = grade.guesses <= hardGuessLimit ? hardPuzzle : expertPuzzle;
+    return grade;
+}
+
+/**
+ * Generates the puzzle of one index from its own random stream.
+ *
+ * @param sudokuSolver The solver used for grading.
+ * @param index The index of the puzzle.
+ * @return The graded puzzle with its solution.
+ */
+GeneratedPuzzle PuzzleGenerator::generateOne(SudokuSolver& sudokuSolver, std::size_t index) const {
+    return generateAttempt(sudokuSolver, index, 0, false);
+}
+
+GeneratedPuzzle PuzzleGenerator::generateAttempt(SudokuSolver& sudokuSolver, std::size_t index, std::uint64_t attempt,
+                                                 bool nakedSinglesOnly) const {
+    std::mt19937_64 random(attemptSeed(seed, index, attempt));
+    GeneratedPuzzle generated;
+    randomGrid(random, generated.solution);
+    removeClues(random, generated.solution, nakedSinglesOnly, generated.puzzle);
+    generated.clues = static_cast<int>(81 - std::count(generated.puzzle.begin(), generated.puzzle.end(), 0));
+    generated.grade = grade(sudokuSolver, generated.puzzle);
+    return generated;
+}
+
+/**
+ * Worker loop: takes puzzle indices from the shared counter until all are taken. When a
+ * difficulty is asked for, attempts with the index's later seeds follow until one matches;
+ * easy puzzles are built to be easy, so their first attempt always is.
+ */
+void PuzzleGenerator::runWorker(std::atomic<std::size_t>& nextIndex, std::vector<GeneratedPuzzle>& puzzles,
+                                const PuzzleDifficulty* difficulty) const {
+    // A solver is a few kilobytes; keep it off the thread's stack
+    std::unique_ptr<SudokuSolver> sudokuSolver(new SudokuSolver());
+    while(true){
+        const std::size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        if(index >= puzzles.size()){
+            return;
+        }
+        std::uint64_t attempt = 0;
+        do {
+            puzzles[index] = generateAttempt(*sudokuSolver, index, attempt++, difficulty != nullptr && *difficulty == easyPuzzle);
+        } while(difficulty != nullptr && puzzles[index].grade.difficulty != *difficulty);
+    }
+}
+
+/**
+ * Generates puzzles on all threads. Puzzle i depends only on the seed and i, so the result is
+ * the same for any thread count.
+ *
+ * @param count The number of puzzles.
+ * @param difficulty The difficulty every puzzle must have, or nullptr for any.
+ * @return The puzzles in index order.
+ */
+std::vector<GeneratedPuzzle> PuzzleGenerator::generate(std::size_t count, const PuzzleDifficulty* difficulty) const {
+    std::vector<GeneratedPuzzle> puzzles(count);
+    std::atomic<std::size_t> nextIndex(0);
+    std::vector<std::thread> workers;
+    for(unsigned worker=1; worker<threadCount; ++worker){
+        workers.emplace_back(&PuzzleGenerator::runWorker, this, std::ref(nextIndex), std::ref(puzzles), difficulty);
+    }
+    // The calling thread works as well
+    runWorker(nextIndex, puzzles, difficulty);
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+    return puzzles;
+}
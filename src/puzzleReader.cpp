@@ -0,0 +1,271 @@
+#include "puzzleReader.hpp"
+#include "packedBoard.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Marks characters that cannot appear in a puzzle line
+const std::uint8_t invalidCell = 0xFF;
+
+// Value of every character: 1 to 9 for digits, 0 for the empty cell markers, invalidCell otherwise
+constexpr std::array<std::uint8_t, 256> makeCellTable(){
+    std::array<std::uint8_t, 256> table{};
+    for(int symbol=0; symbol<256; ++symbol){
+        table[symbol] = invalidCell;
+    }
+    for(int value=1; value<=9; ++value){
+        table['0' + value] = static_cast<std::uint8_t>(value);
+    }
+    table['0'] = 0;
+    table['.'] = 0;
+    table['*'] = 0;
+    return table;
+}
+
+constexpr std::array<std::uint8_t, 256> cellTable = makeCellTable();
+
+PuzzleReader::PuzzleReader()
+    : descriptor(-1), mapped(nullptr), mappedSize(0), bufferStart(0), bufferEnd(0), streamEnded(false),
+      discardingLine(false), position(0), offset(0), lineNumber(0), lineOffset(0), failed(false),
+      packed(false) {}
+
+PuzzleReader::~PuzzleReader(){
+    close();
+}
+
+// Unmaps the file and closes it; stdin is left open.
+void PuzzleReader::close(){
+    if(mapped != nullptr){
+        munmap(const_cast<char*>(mapped), mappedSize);
+        mapped = nullptr;
+    }
+    if(descriptor > STDIN_FILENO){
+        ::close(descriptor);
+    }
+    descriptor = -1;
+}
+
+/**
+ * Opens the input. A non-empty regular file is mapped into memory as a whole; anything else,
+ * including stdin, is read in blocks as parsing goes along.
+ *
+ * @param path The file to read, or "-" for stdin.
+ * @return true if the input could be opened, false otherwise.
+ */
+bool PuzzleReader::open(const std::string& path){
+    close();
+    buffer.clear();
+    bufferStart = bufferEnd = 0;
+    streamEnded = false;
+    discardingLine = false;
+    position = 0;
+    offset = 0;
+    lineNumber = 0;
+    lineOffset = 0;
+    failed = false;
+    packed = false;
+
+    descriptor = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+    if(descriptor < 0){
+        return false;
+    }
+    struct stat status;
+    if(fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0){
+        void* memory = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if(memory != MAP_FAILED){
+            mapped = static_cast<const char*>(memory);
+            mappedSize = static_cast<std::size_t>(status.st_size);
+            // The file is parsed front to back exactly once
+            madvise(memory, mappedSize, MADV_SEQUENTIAL);
+            detectPacked();
+            return true;
+        }
+    }
+    // Streams, pipes and files that cannot be mapped are read block by block
+    buffer.resize(blockSize);
+    detectPacked();
+    return true;
+}
+
+// Switches to packed records and skips the header if the input starts with packedMagic.
+void PuzzleReader::detectPacked(){
+    if(mapped != nullptr){
+        packed = mappedSize >= packedMagicSize && std::memcmp(mapped, packedMagic, packedMagicSize) == 0;
+        position = packed ? packedMagicSize : 0;
+    } else {
+        while(bufferEnd < packedMagicSize && fillBuffer()){}
+        packed = bufferEnd >= packedMagicSize && std::memcmp(buffer.data(), packedMagic, packedMagicSize) == 0;
+        bufferStart = packed ? packedMagicSize : 0;
+    }
+    offset = packed ? packedMagicSize : 0;
+}
+
+/**
+ * Moves the unparsed rest of the block buffer to its front and reads more input behind it.
+ *
+ * @return false if no more input could be read, true otherwise.
+ */
+bool PuzzleReader::fillBuffer(){
+    const std::size_t rest = bufferEnd - bufferStart;
+    std::memmove(buffer.data(), buffer.data() + bufferStart, rest);
+    bufferStart = 0;
+    bufferEnd = rest;
+    while(true){
+        const ssize_t count = ::read(descriptor, buffer.data() + bufferEnd, buffer.size() - bufferEnd);
+        if(count > 0){
+            bufferEnd += static_cast<std::size_t>(count);
+            return true;
+        }
+        if(count < 0 && errno == EINTR){
+            continue;
+        }
+        failed = count < 0;
+        streamEnded = true;
+        return false;
+    }
+}
+
+/**
+ * Finds the next line of the input, without its newline. A line longer than the whole block
+ * buffer is returned as far as it fits (it cannot be a puzzle anyway) and the rest is skipped.
+ *
+ * @param line Receives the start of the line.
+ * @param length Receives the length of the line.
+ * @return false once the input is exhausted, true otherwise.
+ */
+bool PuzzleReader::nextLine(const char*& line, std::size_t& length){
+    if(mapped != nullptr){
+        if(position >= mappedSize){
+            return false;
+        }
+        line = mapped + position;
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', mappedSize - position));
+        length = newline != nullptr ? static_cast<std::size_t>(newline - line) : mappedSize - position;
+        lineOffset = position;
+        position += length + (newline != nullptr ? 1 : 0);
+        ++lineNumber;
+        return true;
+    }
+
+    while(true){
+        const char* start = buffer.data() + bufferStart;
+        const std::size_t available = bufferEnd - bufferStart;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', available));
+        if(discardingLine){
+            // Skip the rest of an overlong line up to its newline
+            const std::size_t skipped = newline != nullptr ? static_cast<std::size_t>(newline - start) + 1 : available;
+            bufferStart += skipped;
+            offset += skipped;
+            discardingLine = newline == nullptr;
+            if(discardingLine && !fillBuffer()){
+                return false;
+            }
+            continue;
+        }
+        if(newline != nullptr || (streamEnded && available > 0) || available == buffer.size()){
+            line = start;
+            length = newline != nullptr ? static_cast<std::size_t>(newline - start) : available;
+            const std::size_t consumed = length + (newline != nullptr ? 1 : 0);
+            lineOffset = offset;
+            bufferStart += consumed;
+            offset += consumed;
+            discardingLine = newline == nullptr && !streamEnded;
+            ++lineNumber;
+            return true;
+        }
+        if(streamEnded){
+            return false;
+        }
+        // At the end of the stream the loop returns the unterminated last line, if there is one
+        fillBuffer();
+    }
+}
+
+/**
+ * Finds the next packed record, waiting for the stream to deliver all of its bytes.
+ *
+ * @param record Receives the start of the record.
+ * @param length Receives its length: packedBoardSize, or less if the input ends inside it.
+ * @return false once the input is exhausted, true otherwise.
+ */
+bool PuzzleReader::nextRecord(const char*& record, std::size_t& length){
+    std::size_t available;
+    if(mapped != nullptr){
+        record = mapped + position;
+        available = mappedSize - position;
+    } else {
+        while(bufferEnd - bufferStart < packedBoardSize && !streamEnded){
+            fillBuffer();
+        }
+        record = buffer.data() + bufferStart;
+        available = bufferEnd - bufferStart;
+    }
+    if(available == 0){
+        return false;
+    }
+    length = std::min(available, packedBoardSize);
+    lineOffset = offset;
+    offset += length;
+    if(mapped != nullptr){
+        position += length;
+    } else {
+        bufferStart += length;
+    }
+    ++lineNumber;
+    return true;
+}
+
+/**
+ * Reads the next puzzle, skipping empty lines.
+ *
+ * @param board Receives the values of the puzzle, 0 for empty cells.
+ * @return puzzleRead for a puzzle, malformedLine for a line that is not one (its position is
+ *         available from getLineNumber and getLineOffset), or endOfInput.
+ */
+PuzzleReader::Status PuzzleReader::next(Board& board){
+    const char* line;
+    std::size_t length;
+    if(packed){
+        if(!nextRecord(line, length)){
+            return endOfInput;
+        }
+        return length == packedBoardSize && unpackBoard(reinterpret_cast<const std::uint8_t*>(line), board) ? puzzleRead : malformedLine;
+    }
+    while(nextLine(line, length)){
+        if(length > 0 && line[length - 1] == '\r'){
+            --length;
+        }
+        if(length == 0){
+            continue;
+        }
+        if(length != board.size()){
+            return malformedLine;
+        }
+        // Collect the table entries of all characters; any invalid one sets all bits of 'invalid'
+        std::uint8_t invalid = 0;
+        for(std::size_t cell=0; cell<board.size(); ++cell){
+            const std::uint8_t value = cellTable[static_cast<unsigned char>(line[cell])];
+            board[cell] = value;
+            invalid |= value & 0xF0;
+        }
+        return invalid == 0 ? puzzleRead : malformedLine;
+    }
+    return endOfInput;
+}
+
+std::uint64_t PuzzleReader::getLineNumber() const {
+    return lineNumber;
+}
+
+std::uint64_t PuzzleReader::getLineOffset() const {
+    return lineOffset;
+}
+
+bool PuzzleReader::hasFailed() const {
+    return failed;
+}
@@ -0,0 +1,173 @@
+#include "solveCache.hpp"
+#include <algorithm>
+#include <cstring>
+
+SolveCache::SolveCache(std::size_t capacity)
+    : entries(std::max<std::size_t>(capacity, 1)), entryCount(0), newest(-1), oldest(-1), hits(0), misses(0) {
+    // At most half of the slots are ever used, which keeps probe sequences short
+    std::size_t slotCount = 2;
+    while(slotCount < 2 * entries.size()){
+        slotCount *= 2;
+    }
+    slots.assign(slotCount, emptySlot);
+    slotMask = slotCount - 1;
+}
+
+// Mixes the key eight bytes at a time.
+std::uint64_t SolveCache::hashKey(const PackedBoard& key){
+    std::uint64_t hash = key.size();
+    std::size_t offset = 0;
+    for(; offset + 8 <= key.size(); offset += 8){
+        std::uint64_t word;
+        std::memcpy(&word, key.data() + offset, 8);
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 29;
+    }
+    for(; offset < key.size(); ++offset){
+        hash = (hash ^ key[offset]) * 0x9E3779B97F4A7C15ull;
+    }
+    return hash ^ (hash >> 32);
+}
+
+std::size_t SolveCache::findSlot(const PackedBoard& key, std::uint64_t hash) const {
+    std::size_t slot = hash & slotMask;
+    while(slots[slot] != emptySlot){
+        const Entry& entry = entries[slots[slot]];
+        if(entry.hash == hash && entry.key == key){
+            return slot;
+        }
+        slot = (slot + 1) & slotMask;
+    }
+    return slot;
+}
+
+/**
+ * Empties a slot of the hash table. Entries further along the probe sequence are shifted back
+ * into the gap unless that would move them in front of their home slot, so lookups never stop
+ * early at the hole.
+ *
+ * @param slot The slot to empty.
+ */
+void SolveCache::removeSlot(std::size_t slot){
+    std::size_t hole = slot;
+    std::size_t next = slot;
+    while(true){
+        slots[hole] = emptySlot;
+        while(true){
+            next = (next + 1) & slotMask;
+            if(slots[next] == emptySlot){
+                return;
+            }
+            const std::size_t home = entries[slots[next]].hash & slotMask;
+            // The entry may fill the hole unless its home lies cyclically in (hole, next]
+            const bool staysBehind = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+            if(!staysBehind){
+                break;
+            }
+        }
+        slots[hole] = slots[next];
+        hole = next;
+    }
+}
+
+void SolveCache::unlink(int entry){
+    Entry& current = entries[entry];
+    if(current.newer >= 0){
+        entries[current.newer].older = current.older;
+    } else {
+        newest = current.older;
+    }
+    if(current.older >= 0){
+        entries[current.older].newer = current.newer;
+    } else {
+        oldest = current.newer;
+    }
+}
+
+void SolveCache::linkNewest(int entry){
+    entries[entry].newer = -1;
+    entries[entry].older = newest;
+    if(newest >= 0){
+        entries[newest].newer = entry;
+    }
+    newest = entry;
+    if(oldest < 0){
+        oldest = entry;
+    }
+}
+
+/**
+ * Looks up the solution of a canonical puzzle and marks it as recently used.
+ *
+ * @param puzzle The canonical puzzle.
+ * @param solution Receives the cached solution, in the orientation of the canonical puzzle.
+ * @return true if the puzzle was cached, false otherwise.
+ */
+bool SolveCache::find(const Board& puzzle, Board& solution){
+    PackedBoard key;
+    packBoard(puzzle, key.data());
+    const std::uint64_t hash = hashKey(key);
+
+    std::lock_guard<std::mutex> guard(lock);
+    const std::size_t slot = findSlot(key, hash);
+    if(slots[slot] == emptySlot){
+        ++misses;
+        return false;
+    }
+    const int entry = slots[slot];
+    unpackBoard(entries[entry].solution.data(), solution);
+    unlink(entry);
+    linkNewest(entry);
+    ++hits;
+    return true;
+}
+
+/**
+ * Stores the solution of a canonical puzzle. Once the cache is full, the least recently used
+ * entry makes room for it.
+ *
+ * @param puzzle The canonical puzzle.
+ * @param solution Its solution, in the same orientation.
+ */
+void SolveCache::insert(const Board& puzzle, const Board& solution){
+    PackedBoard key;
+    packBoard(puzzle, key.data());
+    const std::uint64_t hash = hashKey(key);
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::size_t slot = findSlot(key, hash);
+    int entry = slots[slot];
+    if(entry != emptySlot){
+        // Another solver stored the same puzzle in the meantime
+        unlink(entry);
+    } else {
+        if(entryCount < static_cast<int>(entries.size())){
+            entry = entryCount++;
+        } else {
+            entry = oldest;
+            removeSlot(findSlot(entries[entry].key, entries[entry].hash));
+            unlink(entry);
+            // Removal may have shifted the probe sequence of the new key
+            slot = findSlot(key, hash);
+        }
+        entries[entry].key = key;
+        entries[entry].hash = hash;
+        slots[slot] = entry;
+    }
+    packBoard(solution, entries[entry].solution.data());
+    linkNewest(entry);
+}
+
+std::size_t SolveCache::getCapacity() const {
+    return entries.size();
+}
+
+std::uint64_t SolveCache::getHits() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return hits;
+}
+
+std::uint64_t SolveCache::getMisses() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return misses;
+}
@@ -0,0 +1,169 @@
+#include "solverBackend.hpp"
+#include "sudokuSolver.hpp"
+#include "dlxSolver.hpp"
+#include "variantSolver.hpp"
+#include <iostream>
+#include <fstream>
+
+// Parses the board string into its compact form and reads that.
+template<int Order>
+void BasicSolverBackend<Order>::readBoard(const std::string& board) {
+    Board values;
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        values[cell] = static_cast<std::uint8_t>(symbolValue(board.at(cell), Geometry::size));
+    }
+    readBoard(values);
+}
+
+// Reads the puzzle, which overwrites every cell, and solves it with the working storage of the instance.
+template<int Order>
+bool BasicSolverBackend<Order>::solve(const Board& board) {
+    readBoard(board);
+    return solve();
+}
+
+// Writes the board as one character per cell in row order, using '.' for cells that are not solved.
+template<int Order>
+void BasicSolverBackend<Order>::writeBoard(char* out) const {
+    const Domains& cellValues = getCellValues();
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        const Mask values = cellValues[cell];
+        out[cell] = countCandidates(values) == 1 ? valueSymbol(firstCandidate(values)) : '.';
+    }
+}
+
+// Writes the value of every solved cell into the board, and 0 for the others.
+template<int Order>
+void BasicSolverBackend<Order>::writeBoard(Board& board) const {
+    const Domains& cellValues = getCellValues();
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        const Mask values = cellValues[cell];
+        board[cell] = static_cast<std::uint8_t>(countCandidates(values) == 1 ? firstCandidate(values) : 0);
+    }
+}
+
+// Reads a Sudoku puzzle from a file input by prompting the user.
+template<int Order>
+bool BasicSolverBackend<Order>::readBoardFromFiles(){
+    std::string userInput;
+    std::ifstream file;
+    
+    do{
+        std::cout << "Please enter the file name(including '.txt'),\nOr enter '--exit' to leave the program:\n";
+        std::getline(std::cin, userInput);
+        
+        if(userInput == "--exit"){
+            file.close();
+            return false;
+        }
+        
+        std::cout << "\n ... loading the file ... \n";
+        std::string filePath = "Puzzles/" + userInput;
+        file.open(filePath);
+        
+        if(!file.is_open()){
+            std::cerr << "\nFailed to open the file " << userInput << " . Please check the file location/name and try again. Or enter '--exit' to leave the program.\n\n";
+        }
+    } while(!file.is_open());
+    
+    // Read the file line by line and collect the rows into one board string
+    std::string line;
+    std::string board;
+    int row = 0;
+    while(getline(file, line) && row < Geometry::size){
+        // '*' placeholders for empty cells are accepted as they are by readBoard
+        board += line.substr(0, Geometry::size);
+        ++row;
+    }
+    file.close();
+    if(board.size() != static_cast<std::size_t>(Geometry::cellCount)){
+        std::cerr << "\nThe file " << userInput << " does not hold a " << Geometry::size << "x" << Geometry::size << " puzzle.\n\n";
+        return false;
+    }
+    readBoard(board);
+    std::cout << "\nFile loaded successfully. Here is your puzzle:\n";
+    printStatus();
+    
+    std::cout << "Starts analyzing the puzzle ... \n";
+    return true;
+}
+
+/**
+ * Prints the current status of the Sudoku grid. Cells with multiple possibilities are printed with their possible values.
+ * Empty cells (with all possibilities) are printed as blank.
+ */
+template<int Order>
+void BasicSolverBackend<Order>::printStatus(){
+    const Domains& cellValues = getCellValues();
+    // The grid is formatted into one string and printed with a single write
+    std::string text = "\n";
+    text.reserve(Geometry::cellCount * (Geometry::size + 3) + Geometry::size + 2);
+
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        const Mask values = cellValues[cell];
+        text += '{';
+        if(values != Geometry::allCandidates){
+            for(Mask rest = values; rest != 0; rest &= rest - 1){
+                text += valueSymbol(firstCandidate(rest));
+            }
+        } else {
+            text += ' ';
+        }
+        text += "} ";
+        if(cell % Geometry::size == Geometry::size - 1){
+            text += '\n';
+        }
+    }
+    text += '\n';
+    std::cout << text << std::flush;
+}
+
+template<int Order>
+void BasicSolverBackend<Order>::welcomeMessage() {
+    std::cout << "\n\n";
+    std::cout << "================================================================================\n\n";
+    std::cout << " _________         .___      __          _________      .__             -v1.8.1\n";
+    std::cout << "/   _____/__ __  __| _/____ |  | ____ __/   _____/ ____ |  |___  __ ___________\n";
+    std::cout << "\\_____  \\|  |  \\/ __ |/  _ \\|  |/ /  |  \\_____  \\ /  _ \\|  |\\  \\/ // __ \\_  __ \\\n";
+    std::cout << "/        \\  |  / /_/ (  <_> )    <|  |  /        (  <_> )  |_\\   /\\  ___/|  | \\/\n";
+    std::cout << "/_______ /____/\\_____|\\____/|__|_ \\____/_______  /\\____/|____/\\_/  \\___  >__|\n";
+    std::cout << "       \\/           \\/           \\/            \\/                      \\/\n\n";
+    std::cout << "================================================================================\n";
+    std::cout << "Welcome to Sudoku solver! Let me solve the sudoku puzzle for you ... \n";
+    std::cout << "First, I need your help to load the puzzle file.\n\n";
+    
+    std::cout << "** NOTICE: Ensure that your puzzle files(.txt) are following the format correctly and placed in the 'Puzzles' folder within the project directory! **\n\n";
+}
+
+template<int Order>
+void BasicSolverBackend<Order>::endMessage() {
+  std::cout << "\nThank you and good bye!\n\n";
+    std::cout << "================================================================================\n";
+}
+
+template class BasicSolverBackend<2>;
+template class BasicSolverBackend<3>;
+template class BasicSolverBackend<4>;
+template class BasicSolverBackend<5>;
+template class BasicSolverBackend<6>;
+
+/**
+ * Creates a solver backend by name: "ac3" for the constraint propagation and backtracking solver,
+ * "dlx" for the Dancing Links exact cover solver, "variant" for the variant solver with the
+ * classic rules.
+ *
+ * @param name The name of the backend.
+ * @return The new backend, or an empty pointer if the name is unknown.
+ */
+std::unique_ptr<SolverBackend> makeSolverBackend(const std::string& name){
+    if(name == "ac3"){
+        return std::unique_ptr<SolverBackend>(new SudokuSolver());
+    }
+    if(name == "dlx"){
+        return std::unique_ptr<SolverBackend>(new DlxSolver());
+    }
+    if(name == "variant"){
+        return std::unique_ptr<SolverBackend>(new VariantSolver());
+    }
+    return std::unique_ptr<SolverBackend>();
+}
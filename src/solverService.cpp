@@ -0,0 +1,601 @@
+#include "solverService.hpp"
+#include "sudokuSolver.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+// Value of every puzzle character: 1-9 for clues, 0 for empty cells and 0xFF for anything else
+static constexpr std::array<std::uint8_t, 256> makeCellTable(){
+    std::array<std::uint8_t, 256> table{};
+    for(int symbol=0; symbol<256; ++symbol){
+        table[symbol] = 0xFF;
+    }
+    for(int value=1; value<=9; ++value){
+        table['0' + value] = static_cast<std::uint8_t>(value);
+    }
+    table['0'] = 0;
+    table['.'] = 0;
+    table['*'] = 0;
+    return table;
+}
+static constexpr std::array<std::uint8_t, 256> cellTable = makeCellTable();
+
+// Parses an 81-character puzzle; false if the length or a character is wrong.
+static bool parsePuzzle(const char* text, std::size_t length, Board& puzzle){
+    if(length != puzzle.size()){
+        return false;
+    }
+    std::uint8_t invalid = 0;
+    for(std::size_t cell=0; cell<length; ++cell){
+        const std::uint8_t value = cellTable[static_cast<unsigned char>(text[cell])];
+        invalid |= value & 0x80;
+        puzzle[cell] = value;
+    }
+    return invalid == 0;
+}
+
+static bool setNonBlocking(int descriptor){
+    const int flags = fcntl(descriptor, F_GETFL, 0);
+    return flags >= 0 && fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/**
+ * Histogram bucket of a latency: values below 4ns have their own bucket, larger ones four
+ * buckets per power of two, so a bucket is at most a quarter wider than its lower bound.
+ */
+static int latencyBucket(std::uint64_t nanoseconds){
+    if(nanoseconds < 4){
+        return static_cast<int>(nanoseconds);
+    }
+    const int exponent = 63 - __builtin_clzll(nanoseconds);
+    return (exponent - 1) * 4 + static_cast<int>((nanoseconds >> (exponent - 2)) & 3);
+}
+
+// Smallest latency that falls in the bucket after the given one.
+static std::uint64_t latencyBucketEnd(int bucket){
+    if(bucket < 4){
+        return static_cast<std::uint64_t>(bucket) + 1;
+    }
+    const int exponent = bucket / 4 + 1;
+    return (static_cast<std::uint64_t>(4 + bucket % 4) + 1) << (exponent - 2);
+}
+
+SolverService::SolverService(unsigned threadCount, const std::string& engine)
+    : threadCount(threadCount), engine(engine), solveCache(nullptr), listener(-1), wakePipe{-1, -1},
+      stopRequested(false), nextConnection(0), stopping(false), latencyBuckets{}, latencyTotal(0), latencyMax(0) {
+    if(this->threadCount == 0){
+        this->threadCount = std::thread::hardware_concurrency();
+    }
+    if(this->threadCount == 0){
+        // hardware_concurrency() may not know the core count
+        this->threadCount = 1;
+    }
+}
+
+SolverService::~SolverService(){
+    for(std::pair<const std::uint64_t, Connection>& entry : connections){
+        close(entry.second.descriptor);
+    }
+    if(listener >= 0){
+        close(listener);
+    }
+    if(!socketPath.empty()){
+        unlink(socketPath.c_str());
+    }
+    for(int descriptor : wakePipe){
+        if(descriptor >= 0){
+            close(descriptor);
+        }
+    }
+}
+
+void SolverService::setSolveCache(SolveCache* cache){
+    solveCache = cache;
+}
+
+const std::string& SolverService::getAddress() const {
+    return address;
+}
+
+unsigned SolverService::getThreadCount() const {
+    return threadCount;
+}
+
+/**
+ * Opens the listening socket. Unix-domain addresses are "unix:<path>" or any path with a '/';
+ * everything else is "[host:]port" on a loopback address, 127.0.0.1 if no host is given.
+ *
+ * @param address The address to listen on.
+ * @return true if the service is listening, false otherwise (the reason is printed on stderr).
+ */
+bool SolverService::open(const std::string& address){
+    if(pipe(wakePipe) != 0 || !setNonBlocking(wakePipe[0]) || !setNonBlocking(wakePipe[1])){
+        std::cerr << "Failed to create the wake-up pipe: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if(address.compare(0, 5, "unix:") == 0){
+        return listenUnix(address.substr(5));
+    }
+    if(address.find('/') != std::string::npos){
+        return listenUnix(address);
+    }
+    return listenTcp(address);
+}
+
+bool SolverService::listenUnix(const std::string& path){
+    sockaddr_un socketAddress{};
+    socketAddress.sun_family = AF_UNIX;
+    if(path.empty() || path.size() >= sizeof(socketAddress.sun_path)){
+        std::cerr << "Invalid socket path '" << path << "'\n";
+        return false;
+    }
+    std::memcpy(socketAddress.sun_path, path.c_str(), path.size() + 1);
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0){
+        std::cerr << "Failed to create a socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    const sockaddr* boundAddress = reinterpret_cast<const sockaddr*>(&socketAddress);
+    bool bound = bind(listener, boundAddress, sizeof(socketAddress)) == 0;
+    if(!bound && errno == EADDRINUSE){
+        // A socket file left behind by a service that is gone refuses connections and may be replaced
+        const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool stale = probe >= 0 && connect(probe, boundAddress, sizeof(socketAddress)) != 0 && errno == ECONNREFUSED;
+        if(probe >= 0){
+            close(probe);
+        }
+        if(stale && unlink(path.c_str()) == 0){
+            bound = bind(listener, boundAddress, sizeof(socketAddress)) == 0;
+        } else {
+            errno = EADDRINUSE;
+        }
+    }
+    if(!bound){
+        std::cerr << "Failed to bind to " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    socketPath = path;
+    if(listen(listener, SOMAXCONN) != 0 || !setNonBlocking(listener)){
+        std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    this->address = "unix:" + path;
+    return true;
+}
+
+bool SolverService::listenTcp(const std::string& hostPort){
+    const std::size_t colon = hostPort.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : hostPort.substr(0, colon);
+    const std::string port = colon == std::string::npos ? hostPort : hostPort.substr(colon + 1);
+    if(host == "localhost"){
+        host = "127.0.0.1";
+    }
+    sockaddr_in socketAddress{};
+    socketAddress.sin_family = AF_INET;
+    char* end = nullptr;
+    const unsigned long portNumber = std::strtoul(port.c_str(), &end, 10);
+    if(port.empty() || *end != '\0' || portNumber > 65535 || inet_pton(AF_INET, host.c_str(), &socketAddress.sin_addr) != 1){
+        std::cerr << "Invalid address '" << hostPort << "'\n";
+        return false;
+    }
+    // The protocol has no authentication, so it is only offered to local clients
+    if((ntohl(socketAddress.sin_addr.s_addr) >> 24) != 127){
+        std::cerr << "Only loopback addresses (127.x.x.x) are served, not " << host << "\n";
+        return false;
+    }
+    socketAddress.sin_port = htons(static_cast<std::uint16_t>(portNumber));
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if(listener < 0){
+        std::cerr << "Failed to create a socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    const int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if(bind(listener, reinterpret_cast<const sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0
+       || listen(listener, SOMAXCONN) != 0 || !setNonBlocking(listener)){
+        std::cerr << "Failed to listen on " << hostPort << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    // Port 0 asks for any free port; report the one that was taken
+    socklen_t length = sizeof(socketAddress);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&socketAddress), &length);
+    this->address = host + ":" + std::to_string(ntohs(socketAddress.sin_port));
+    return true;
+}
+
+// Wakes the I/O thread. A full pipe already holds a pending wake-up, so a failed write is harmless.
+void SolverService::wake(){
+    const char signal = 1;
+    ssize_t written = write(wakePipe[1], &signal, 1);
+    (void)written;
+}
+
+// Sets the stop flag and wakes the I/O thread; only uses async-signal-safe calls.
+void SolverService::stop(){
+    stopRequested.store(true);
+    wake();
+}
+
+void SolverService::acceptClients(){
+    while(true){
+        const int descriptor = accept(listener, nullptr, nullptr);
+        if(descriptor < 0){
+            // EAGAIN once every pending client is taken; other errors concern only that client
+            if(errno == EINTR || errno == ECONNABORTED){
+                continue;
+            }
+            return;
+        }
+        setNonBlocking(descriptor);
+        // Answers are single short lines, which should not wait for more data to fill a segment
+        const int noDelay = 1;
+        setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        connections.emplace(nextConnection++, Connection{descriptor, std::string(), std::string(), 0, 0, false, false});
+        std::lock_guard<std::mutex> guard(lock);
+        metrics.connections = connections.size();
+    }
+}
+
+/**
+ * Answers a request line at once (stats and malformed lines) or queues its puzzle for the workers.
+ *
+ * @param id The id of the client's connection.
+ * @param connection The client's connection.
+ * @param line The line, without its newline.
+ * @param length The length of the line.
+ */
+void SolverService::handleLine(std::uint64_t id, Connection& connection, const char* line, std::size_t length){
+    if(length != 0 && line[length - 1] == '\r'){
+        --length;
+    }
+    if(length == 0){
+        return;
+    }
+    if(length == 5 && std::memcmp(line, "stats", 5) == 0){
+        connection.output += formatMetrics();
+        return;
+    }
+    const char* space = static_cast<const char*>(std::memchr(line, ' ', length));
+    const std::size_t tagLength = space == nullptr ? 0 : static_cast<std::size_t>(space - line);
+    const char* puzzle = space == nullptr ? line : space + 1;
+    const std::size_t puzzleLength = length - (space == nullptr ? 0 : tagLength + 1);
+
+    Request request;
+    if(!parsePuzzle(puzzle, puzzleLength, request.puzzle)){
+        if(space != nullptr){
+            connection.output.append(line, tagLength).push_back(' ');
+        }
+        connection.output += "error expected a puzzle of 81 characters: 1-9 for clues, 0, . or * for empty cells\n";
+        std::lock_guard<std::mutex> guard(lock);
+        ++metrics.malformed;
+        return;
+    }
+    request.connection = id;
+    request.tag.assign(line, tagLength);
+    request.received = std::chrono::steady_clock::now();
+    ++connection.pending;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        requests.push_back(std::move(request));
+        ++metrics.requests;
+        metrics.maxQueueDepth = std::max(metrics.maxQueueDepth, requests.size());
+    }
+    requestsAvailable.notify_one();
+}
+
+/**
+ * Reads once from a client and handles every complete line. A line longer than any request is
+ * answered with an error and skipped up to its newline.
+ *
+ * @return false if the connection failed, true otherwise (including when the client closed its end).
+ */
+bool SolverService::readClient(std::uint64_t id, Connection& connection){
+    char buffer[1 << 16];
+    const ssize_t received = recv(connection.descriptor, buffer, sizeof(buffer), 0);
+    if(received < 0){
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if(received == 0){
+        // A last line without a newline is still a request
+        if(!connection.discardingLine && !connection.input.empty()){
+            handleLine(id, connection, connection.input.data(), connection.input.size());
+        }
+        connection.input.clear();
+        connection.inputClosed = true;
+        return true;
+    }
+
+    const char* start = buffer;
+    const char* end = buffer + received;
+    while(const char* newline = static_cast<const char*>(std::memchr(start, '\n', static_cast<std::size_t>(end - start)))){
+        if(connection.discardingLine){
+            connection.discardingLine = false;
+        } else if(connection.input.size() + static_cast<std::size_t>(newline - start) > maxLineLength){
+            // Too long whether it arrived whole or in parts
+            rejectLongLine(connection);
+        } else if(connection.input.empty()){
+            // Most lines arrive whole and are handled in place
+            handleLine(id, connection, start, static_cast<std::size_t>(newline - start));
+        } else {
+            connection.input.append(start, newline);
+            handleLine(id, connection, connection.input.data(), connection.input.size());
+            connection.input.clear();
+        }
+        start = newline + 1;
+    }
+    if(!connection.discardingLine){
+        connection.input.append(start, end);
+        if(connection.input.size() > maxLineLength){
+            // The rest of the line is dropped as it arrives
+            rejectLongLine(connection);
+            connection.discardingLine = true;
+        }
+    }
+    return true;
+}
+
+// Answers a line longer than maxLineLength with an error and drops what was buffered of it.
+void SolverService::rejectLongLine(Connection& connection){
+    connection.output += "error line too long\n";
+    connection.input.clear();
+    std::lock_guard<std::mutex> guard(lock);
+    ++metrics.malformed;
+}
+
+// Sends queued output until it is gone or the socket is full; false on an error.
+bool SolverService::writeClient(Connection& connection){
+    while(connection.outputOffset < connection.output.size()){
+        const ssize_t sent = send(connection.descriptor, connection.output.data() + connection.outputOffset,
+                                  connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if(sent < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.outputOffset += static_cast<std::size_t>(sent);
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    return true;
+}
+
+void SolverService::collectResponses(){
+    std::vector<Response> ready;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        ready.swap(responses);
+    }
+    for(Response& response : ready){
+        std::unordered_map<std::uint64_t, Connection>::iterator entry = connections.find(response.connection);
+        // The client may have gone while its puzzle was being solved
+        if(entry != connections.end()){
+            entry->second.output += response.line;
+            --entry->second.pending;
+        }
+    }
+}
+
+/**
+ * Worker loop: waits for puzzles, takes up to a batch of them at once and solves them with a
+ * solver that lives as long as the worker. Answers and latencies are published once per batch.
+ */
+void SolverService::runWorker(){
+    std::unique_ptr<SolverBackend> sudokuSolver = makeSolverBackend(engine);
+    SudokuSolver* ac3Solver = dynamic_cast<SudokuSolver*>(sudokuSolver.get());
+    if(ac3Solver != nullptr){
+        ac3Solver->setSolveCache(solveCache);
+    }
+    std::vector<Request> batch;
+    std::vector<Response> answers;
+    std::vector<std::uint64_t> latencies;
+    char solution[81];
+
+    while(true){
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            requestsAvailable.wait(guard, [this]{ return stopping || !requests.empty(); });
+            if(stopping){
+                return;
+            }
+            const std::size_t count = std::min(requests.size(), maxBatchSize);
+            std::move(requests.begin(), requests.begin() + count, std::back_inserter(batch));
+            requests.erase(requests.begin(), requests.begin() + count);
+            ++metrics.batches;
+        }
+
+        answers.clear();
+        latencies.clear();
+        std::uint64_t solved = 0;
+        for(Request& request : batch){
+            const bool solvedPuzzle = sudokuSolver->solve(request.puzzle);
+            std::string line = std::move(request.tag);
+            if(!line.empty()){
+                line.push_back(' ');
+            }
+            if(solvedPuzzle){
+                sudokuSolver->writeBoard(solution);
+                line.append(solution, sizeof(solution));
+                ++solved;
+            } else {
+                line += "unsolvable";
+            }
+            line.push_back('\n');
+            answers.push_back(Response{request.connection, std::move(line)});
+            latencies.push_back(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - request.received).count()));
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::move(answers.begin(), answers.end(), std::back_inserter(responses));
+            for(std::uint64_t latency : latencies){
+                recordLatency(latency);
+            }
+            metrics.solved += solved;
+            metrics.unsolvable += batch.size() - solved;
+        }
+        wake();
+    }
+}
+
+// Adds a latency to the histogram; called with the lock held.
+void SolverService::recordLatency(std::uint64_t nanoseconds){
+    ++latencyBuckets[latencyBucket(nanoseconds)];
+    latencyTotal += nanoseconds;
+    latencyMax = std::max(latencyMax, nanoseconds);
+}
+
+/**
+ * Estimates a latency percentile from the histogram, as the upper end of the bucket it falls in
+ * (never above the largest latency seen). Called with the lock held.
+ *
+ * @param fraction The fraction of answers that are at least as fast, e.g. 0.99.
+ * @return The latency in microseconds, 0 if nothing was answered yet.
+ */
+double SolverService::latencyPercentile(double fraction) const {
+    const std::uint64_t answered = metrics.solved + metrics.unsolvable;
+    if(answered == 0){
+        return 0.0;
+    }
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * answered + 0.5));
+    std::uint64_t seen = 0;
+    for(int bucket=0; bucket<latencyBucketCount; ++bucket){
+        seen += latencyBuckets[bucket];
+        if(seen >= rank){
+            return std::min(latencyBucketEnd(bucket), latencyMax) / 1000.0;
+        }
+    }
+    return latencyMax / 1000.0;
+}
+
+// The metrics as the answer to a stats request.
+std::string SolverService::formatMetrics() const {
+    const ServiceMetrics current = getMetrics();
+    return "stats requests=" + std::to_string(current.requests) + " solved=" + std::to_string(current.solved)
+         + " unsolvable=" + std::to_string(current.unsolvable) + " malformed=" + std::to_string(current.malformed)
+         + " batches=" + std::to_string(current.batches) + " queued=" + std::to_string(current.queueDepth)
+         + " maxQueued=" + std::to_string(current.maxQueueDepth) + " connections=" + std::to_string(current.connections)
+         + " meanMicros=" + std::to_string(current.meanMicros) + " p50Micros=" + std::to_string(current.p50Micros)
+         + " p99Micros=" + std::to_string(current.p99Micros) + " maxMicros=" + std::to_string(current.maxMicros) + "\n";
+}
+
+ServiceMetrics SolverService::getMetrics() const {
+    std::lock_guard<std::mutex> guard(lock);
+    ServiceMetrics current = metrics;
+    current.queueDepth = requests.size();
+    const std::uint64_t answered = metrics.solved + metrics.unsolvable;
+    current.meanMicros = answered == 0 ? 0.0 : latencyTotal / 1000.0 / answered;
+    current.p50Micros = latencyPercentile(0.5);
+    current.p99Micros = latencyPercentile(0.99);
+    current.maxMicros = latencyMax / 1000.0;
+    return current;
+}
+
+/**
+ * Serves clients until stop() is called: starts the workers, then runs the I/O loop on the
+ * calling thread. Puzzles still queued when the service stops are dropped.
+ *
+ * @return false if the service was not opened, true once it has stopped.
+ */
+bool SolverService::run(){
+    if(address.empty()){
+        return false;
+    }
+    std::vector<std::thread> workers;
+    for(unsigned worker=0; worker<threadCount; ++worker){
+        workers.emplace_back(&SolverService::runWorker, this);
+    }
+
+    std::vector<pollfd> descriptors;
+    std::vector<std::uint64_t> polledIds;
+    while(!stopRequested.load()){
+        bool queueFull;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            queueFull = requests.size() >= maxQueueDepth;
+        }
+        descriptors.clear();
+        polledIds.clear();
+        descriptors.push_back(pollfd{wakePipe[0], POLLIN, 0});
+        descriptors.push_back(pollfd{listener, POLLIN, 0});
+        for(std::pair<const std::uint64_t, Connection>& entry : connections){
+            const Connection& connection = entry.second;
+            short events = 0;
+            // Clients that do not read their answers are not read from either
+            if(!queueFull && !connection.inputClosed && connection.output.size() - connection.outputOffset < maxUnsentOutput){
+                events |= POLLIN;
+            }
+            if(connection.outputOffset < connection.output.size()){
+                events |= POLLOUT;
+            }
+            // A closed client keeps reporting a hang-up, so it is only polled while output is waiting
+            descriptors.push_back(pollfd{events != 0 ? connection.descriptor : -1, events, 0});
+            polledIds.push_back(entry.first);
+        }
+        if(poll(descriptors.data(), descriptors.size(), -1) < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            std::cerr << "poll failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        if(descriptors[0].revents & POLLIN){
+            char drained[256];
+            while(read(wakePipe[0], drained, sizeof(drained)) > 0){
+            }
+            collectResponses();
+        }
+        if(descriptors[1].revents & POLLIN){
+            acceptClients();
+        }
+        bool closed = false;
+        for(std::size_t polled=0; polled<polledIds.size(); ++polled){
+            std::unordered_map<std::uint64_t, Connection>::iterator entry = connections.find(polledIds[polled]);
+            Connection& connection = entry->second;
+            bool alive = true;
+            if(descriptors[polled + 2].revents & (POLLIN | POLLHUP | POLLERR)){
+                alive = readClient(entry->first, connection);
+            }
+            // Answers of this round go out right away, without waiting for the next poll
+            if(alive){
+                alive = writeClient(connection);
+            }
+            if(!alive || (connection.inputClosed && connection.pending == 0 && connection.output.empty())){
+                close(connection.descriptor);
+                connections.erase(entry);
+                closed = true;
+            }
+        }
+        if(closed){
+            std::lock_guard<std::mutex> guard(lock);
+            metrics.connections = connections.size();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+        requests.clear();
+    }
+    requestsAvailable.notify_all();
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+    return true;
+}
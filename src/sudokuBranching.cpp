@@ -0,0 +1,129 @@
+#include "sudokuSolver.hpp"
+#include <algorithm>
+
+static const char* const cellSelectionNames[cellSelectionCount] = {"mrv", "degree"};
+static const char* const valueOrderingNames[valueOrderingCount] = {"ascending", "lcv", "hidden"};
+
+const char* cellSelectionName(CellSelection selection){
+    return cellSelectionNames[selection];
+}
+
+const char* valueOrderingName(ValueOrdering ordering){
+    return valueOrderingNames[ordering];
+}
+
+// Number of the given cells with more than one candidate left.
+template<typename Domains, typename Cells>
+static int countUnsolved(const Domains& cellValues, const Cells& cells){
+    int unsolved = 0;
+    for(auto cell : cells){
+        unsolved += countCandidates(cellValues[cell]) > 1 ? 1 : 0;
+    }
+    return unsolved;
+}
+
+/**
+ * Selects the cell to guess next with the minimum remaining values heuristic, in a single pass
+ * over the domains. Plain MRV stops at the first cell with two candidates, since none can have
+ * fewer. With the degree tie-break, a cell with as few candidates as the best so far replaces it
+ * if it has more unsolved peers, so the guess constrains as much of the board as possible; peers
+ * are only counted for such ties.
+ *
+ * @return The unsolved cell to guess on; the board must have one.
+ */
+template<int Order>
+int BasicSudokuSolver<Order>::selectGuessCell() const {
+    const bool breakTies = branching.cellSelection == degreeTieBreak;
+    int bestCell = -1;
+    int bestSize = Geometry::size + 1;
+    // Unsolved peers of the best cell, -1 until a tie needs them
+    int bestDegree = -1;
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        const int size = countCandidates(cellValues[cell]);
+        if(size <= 1 || size > bestSize){
+            continue;
+        }
+        if(size < bestSize){
+            bestCell = cell;
+            bestSize = size;
+            bestDegree = -1;
+            if(size == 2 && !breakTies){
+                break;
+            }
+        } else if(breakTies){
+            if(bestDegree < 0){
+                bestDegree = countUnsolved(cellValues, topology().peers[bestCell]);
+            }
+            const int degree = countUnsolved(cellValues, topology().peers[cell]);
+            if(degree > bestDegree){
+                bestCell = cell;
+                bestDegree = degree;
+            }
+        }
+    }
+    return bestCell;
+}
+
+/**
+ * Selects the value to try next at a guess level. The board is back in the state the level was
+ * opened in whenever a value is picked, so the scores can be computed from the current domains.
+ * Least constraining value scores a value by the peers that still hold it, which are the
+ * candidates the guess removes. The hidden single ordering scores it by its fewest other places
+ * in one of the cell's units, so values that are nearly hidden singles here come first.
+ * Ties go to the smallest value.
+ *
+ * @param frame The guess level; at least one value is untried.
+ * @return The value to try.
+ */
+template<int Order>
+int BasicSudokuSolver<Order>::selectGuessValue(const SearchFrame& frame) const {
+    if(branching.valueOrdering == ascendingValues || countCandidates(frame.untried) == 1){
+        return firstCandidate(frame.untried);
+    }
+    std::array<int, Geometry::size> scores;
+    if(branching.valueOrdering == leastConstrainingValue){
+        scores.fill(0);
+        for(CellId peer : topology().peers[frame.cell]){
+            for(Mask rest = cellValues[peer] & frame.untried; rest != 0; rest &= rest - 1){
+                ++scores[firstCandidate(rest) - 1];
+            }
+        }
+    } else {
+        scores.fill(Geometry::size);
+        for(int unit : topology().cellUnits[frame.cell]){
+            std::array<int, Geometry::size> places{};
+            for(CellId cell : topology().units[unit]){
+                if(cell == frame.cell){
+                    continue;
+                }
+                for(Mask rest = cellValues[cell] & frame.untried; rest != 0; rest &= rest - 1){
+                    ++places[firstCandidate(rest) - 1];
+                }
+            }
+            for(Mask rest = frame.untried; rest != 0; rest &= rest - 1){
+                const int index = firstCandidate(rest) - 1;
+                scores[index] = std::min(scores[index], places[index]);
+            }
+        }
+    }
+    int bestValue = 0;
+    for(Mask rest = frame.untried; rest != 0; rest &= rest - 1){
+        const int value = firstCandidate(rest);
+        if(bestValue == 0 || scores[value - 1] < scores[bestValue - 1]){
+            bestValue = value;
+        }
+    }
+    return bestValue;
+}
+
+// The class itself is instantiated in sudokuSolver.cpp; the members defined here are instantiated
+// one by one, since a class may only be explicitly instantiated once
+#define INSTANTIATE_BRANCHING(order) \
+    template int BasicSudokuSolver<order>::selectGuessCell() const; \
+    template int BasicSudokuSolver<order>::selectGuessValue(const BasicSudokuSolver<order>::SearchFrame&) const;
+
+INSTANTIATE_BRANCHING(2)
+INSTANTIATE_BRANCHING(3)
+INSTANTIATE_BRANCHING(4)
+INSTANTIATE_BRANCHING(5)
+INSTANTIATE_BRANCHING(6)
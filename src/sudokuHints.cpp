@@ -0,0 +1,241 @@
+#include "sudokuSolver.hpp"
+
+static const char* const hintTechniqueNames[hintTechniqueCount] = {
+    "naked single", "hidden single", "intersection", "naked subset", "hidden subset", "solution", "mistake", "none"
+};
+
+const char* hintTechniqueName(HintTechnique technique){
+    return hintTechniqueNames[technique];
+}
+
+/**
+ * Starts a hint session on the board read last. Its solved cells are the clues, which cannot be
+ * taken back. The puzzle is solved once up front, so that hints can fall back on the solution and
+ * spot placed values that are wrong; the board is then reset to the clues with their values
+ * eliminated from their peers (AC-3), which is the state that place and unplace update.
+ *
+ * @return true if the puzzle has a solution, false otherwise (hints then only use the techniques,
+ *         and none are given if the clues clash).
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::startHints(){
+    const Domains clues = cellValues;
+    sessionSolved = search(nullptr, 1, nullptr) == 1;
+    if(sessionSolved){
+        sessionSolution = cellValues;
+    }
+
+    loadCellValues(clues);
+    clearPropagationQueues();
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        cellPlaced[cell] = countCandidates(clues[cell]) == 1;
+        if(cellPlaced[cell]){
+            solvedQueue[solvedCount++] = static_cast<CellId>(cell);
+        }
+    }
+    // Clashing clues are rolled back to the board as read; the session then refuses every placement and hint
+    const int trailMark = trailSize;
+    sessionConsistent = eliminateSolved();
+    clearPropagationQueues();
+    if(!sessionConsistent){
+        undoTrail(trailMark);
+    }
+    placementCount = 0;
+    sessionActive = true;
+    return sessionSolved;
+}
+
+/**
+ * Narrows a cell to a value and removes the values of every cell solved by that from their peers.
+ *
+ * @param cell The cell.
+ * @param value The candidate bit of the value.
+ * @return false if this contradicts the board, which is then restored; true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::applyPlacement(int cell, Mask value){
+    const int trailMark = trailSize;
+    clearPropagationQueues();
+    // A cell that was already down to this value had it eliminated when it got there
+    const bool consistent = narrowCell(cell, value) && eliminateSolved();
+    clearPropagationQueues();
+    if(!consistent){
+        undoTrail(trailMark);
+    }
+    return consistent;
+}
+
+/**
+ * Places a value in an open cell. Only the placed cell's value is eliminated from its peers, and
+ * from the peers of any cell that leaves with a single candidate, so the cost depends on what the
+ * move changes rather than on the size of the board.
+ *
+ * @param cell The cell, in row order.
+ * @param value The value, from 1 to the board size.
+ * @return false if the clues clash, the cell is out of range or already filled, or the value is no
+ *         longer a candidate of the cell or leaves a peer without any; the board is unchanged then.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::place(int cell, int value){
+    if(!sessionActive || !sessionConsistent || cell < 0 || cell >= Geometry::cellCount || value < 1 || value > Geometry::size || cellPlaced[cell]){
+        return false;
+    }
+    const Mask bit = Geometry::candidateBit(value);
+    const int trailMark = trailSize;
+    if((cellValues[cell] & bit) == 0 || !applyPlacement(cell, bit)){
+        return false;
+    }
+    placements[placementCount++] = Placement{static_cast<CellId>(cell), bit, trailMark};
+    cellPlaced[cell] = true;
+    return true;
+}
+
+/**
+ * Takes back a placed value. The board is rolled back to just before that placement, and the
+ * placements made after it are applied again; removing a value only widens domains, so they all
+ * still fit.
+ *
+ * @param cell The cell, in row order.
+ * @return false if the cell holds a clue or no value, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::unplace(int cell){
+    if(!sessionActive){
+        return false;
+    }
+    int index = placementCount - 1;
+    while(index >= 0 && placements[index].cell != cell){
+        --index;
+    }
+    if(index < 0){
+        return false;
+    }
+    undoTrail(placements[index].trailMark);
+    cellPlaced[cell] = false;
+    int kept = index;
+    for(int later=index+1; later<placementCount; ++later){
+        Placement placement = placements[later];
+        placement.trailMark = trailSize;
+        if(applyPlacement(placement.cell, placement.value)){
+            placements[kept++] = placement;
+        } else {
+            cellPlaced[placement.cell] = false;
+        }
+    }
+    placementCount = kept;
+    return true;
+}
+
+// Finds an open cell whose domain is down to a single value.
+template<int Order>
+int BasicSudokuSolver<Order>::findUnplacedSingle() const {
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        if(!cellPlaced[cell] && countCandidates(cellValues[cell]) == 1){
+            return cell;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Applies the unit rules of the propagation engine, one technique level at a time: first hidden
+ * singles alone, then with intersections added, then naked and then hidden subsets. Each level
+ * sweeps every unit until a cell is left with a single value, which is the hint and is credited to
+ * that level, or until nothing changes. The board is changed; the caller rolls it back.
+ *
+ * @return The hint, or technique noHint if no level finds one or the board turns out to contradict itself.
+ */
+template<int Order>
+SudokuHint BasicSudokuSolver<Order>::findTechniqueHint(){
+    for(int level = hiddenSingleHint; level <= hiddenSubsetHint; ++level){
+        bool changed = true;
+        while(changed){
+            changed = false;
+            for(int unit=0; unit<Geometry::unitCount; ++unit){
+                const int trailMark = trailSize;
+                bool consistent = applyHiddenSingles(unit);
+                consistent = consistent && (level < intersectionHint || applyIntersections(unit));
+                consistent = consistent && (level < nakedSubsetHint || applyNakedSubsets(unit));
+                consistent = consistent && (level < hiddenSubsetHint || applyHiddenSubsets(unit));
+                consistent = consistent && eliminateSolved();
+                clearPropagationQueues();
+                if(!consistent){
+                    return SudokuHint();
+                }
+                if(trailSize == trailMark){
+                    continue;
+                }
+                changed = true;
+                const int cell = findUnplacedSingle();
+                if(cell >= 0){
+                    return SudokuHint{cell, firstCandidate(cellValues[cell]), static_cast<HintTechnique>(level)};
+                }
+            }
+        }
+    }
+    return SudokuHint();
+}
+
+/**
+ * Finds the next value to place with the simplest technique that yields one. A placed value
+ * that differs from the solution comes first, since nothing built on it can be trusted. Then a
+ * cell left with a single candidate is a naked single, and otherwise the unit rules are tried in
+ * order of strength on a scratch part of the trail. When none of them places a value, the open
+ * cell with the fewest candidates gets its value from the solution.
+ *
+ * @return The hint; its technique is noHint once every cell is filled, if the clues clash, or if the
+ *         puzzle has no solution and no technique applies.
+ */
+template<int Order>
+SudokuHint BasicSudokuSolver<Order>::nextHint(){
+    if(!sessionActive || !sessionConsistent){
+        return SudokuHint();
+    }
+    if(sessionSolved){
+        for(int index=0; index<placementCount; ++index){
+            const int cell = placements[index].cell;
+            if((placements[index].value & sessionSolution[cell]) == 0){
+                return SudokuHint{cell, firstCandidate(sessionSolution[cell]), mistakeHint};
+            }
+        }
+    }
+    const int single = findUnplacedSingle();
+    if(single >= 0){
+        return SudokuHint{single, firstCandidate(cellValues[single]), nakedSingleHint};
+    }
+
+    const int trailMark = trailSize;
+    const SudokuHint hint = findTechniqueHint();
+    undoTrail(trailMark);
+    if(hint.technique != noHint || !sessionSolved){
+        return hint;
+    }
+
+    int guessCell = -1;
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        if(!cellPlaced[cell] && (guessCell < 0 || countCandidates(cellValues[cell]) < countCandidates(cellValues[guessCell]))){
+            guessCell = cell;
+        }
+    }
+    if(guessCell < 0){
+        return SudokuHint();
+    }
+    return SudokuHint{guessCell, firstCandidate(sessionSolution[guessCell]), solutionHint};
+}
+
+// The class itself is instantiated in sudokuSolver.cpp; the members defined here are instantiated
+// one by one, since a class may only be explicitly instantiated once
+#define INSTANTIATE_HINTS(order) \
+    template bool BasicSudokuSolver<order>::startHints(); \
+    template bool BasicSudokuSolver<order>::applyPlacement(int, BasicSudokuSolver<order>::Mask); \
+    template bool BasicSudokuSolver<order>::place(int, int); \
+    template bool BasicSudokuSolver<order>::unplace(int); \
+    template int BasicSudokuSolver<order>::findUnplacedSingle() const; \
+    template SudokuHint BasicSudokuSolver<order>::findTechniqueHint(); \
+    template SudokuHint BasicSudokuSolver<order>::nextHint();
+
+INSTANTIATE_HINTS(2)
+INSTANTIATE_HINTS(3)
+INSTANTIATE_HINTS(4)
+INSTANTIATE_HINTS(5)
+INSTANTIATE_HINTS(6)
@@ -0,0 +1,364 @@
+#include "sudokuSolver.hpp"
+#include "eliminationKernel.hpp"
+
+// Unit types, in the order of the sudokuTopology units and cellUnits tables
+const int rowUnit = 0;
+const int blockUnit = 2;
+
+/**
+ * Narrows the domain of a cell to the given values and schedules the work that follows from it:
+ * the cell's row, column and block are queued for the unit rules, and a cell that just became
+ * solved is queued for elimination from its peers.
+ *
+ * @param cell The cell to modify.
+ * @param mask The values the cell may keep; candidates outside it are removed.
+ * @return false if the cell has no candidate left, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::narrowCell(int cell, Mask mask){
+    const Mask current = cellValues[cell];
+    const Mask narrowed = current & mask;
+    if(narrowed == current){
+        return true;
+    }
+    setCellValues(cell, narrowed);
+    if(narrowed == 0){
+        return false;
+    }
+    if(countCandidates(narrowed) == 1){
+        solvedQueue[solvedCount++] = static_cast<CellId>(cell);
+    }
+    for(std::uint8_t unit : topology().cellUnits[cell]){
+        if(!unitQueued[unit]){
+            unitQueued[unit] = true;
+            unitQueue[(unitHead + unitPending) % unitQueue.size()] = unit;
+            ++unitPending;
+        }
+    }
+    return true;
+}
+
+// Drops all pending propagation work, e.g. after a contradiction.
+template<int Order>
+void BasicSudokuSolver<Order>::clearPropagationQueues(){
+    solvedCount = 0;
+    unitHead = 0;
+    unitPending = 0;
+    unitQueued.fill(false);
+}
+
+/**
+ * Hidden singles: a value that fits in only one cell of the unit must go there.
+ * A value that fits nowhere, or two values that only fit the same cell, is a contradiction.
+ *
+ * @param unit The unit to examine.
+ * @return false on a contradiction, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::applyHiddenSingles(int unit){
+    const std::array<CellId, Geometry::size>& cells = topology().units[unit];
+    // Values seen in at least one cell, and in at least two cells
+    Mask once = 0;
+    Mask twice = 0;
+    for(CellId cell : cells){
+        twice |= once & cellValues[cell];
+        once |= cellValues[cell];
+    }
+    if(once != Geometry::allCandidates){
+        return false;
+    }
+    for(Mask rest = once & ~twice; rest != 0; rest &= rest - 1){
+        const Mask bit = rest & -rest;
+        bool placed = false;
+        for(CellId cell : cells){
+            if(cellValues[cell] & bit){
+                if constexpr(solverStatsEnabled){
+                    solverStats.hiddenSingles += cellValues[cell] != bit ? 1 : 0;
+                }
+                if(!narrowCell(cell, bit)){
+                    return false;
+                }
+                placed = true;
+                break;
+            }
+        }
+        // The only cell for this value was already taken by another hidden single
+        if(!placed){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Pointing and box-line reduction: when every cell of a block that can hold a value lies in one row
+ * (or column), no other cell of that row can hold it, and vice versa for a row or column whose
+ * cells for a value all lie in one block.
+ *
+ * @param unit The unit to examine.
+ * @return false on a contradiction, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::applyIntersections(int unit){
+    const std::array<CellId, Geometry::size>& cells = topology().units[unit];
+    const int type = unit / Geometry::size;
+    for(Mask bit = 1; bit & Geometry::allCandidates; bit = static_cast<Mask>(bit << 1)){
+        // The line units (or the block unit) shared by all cells that can hold the value
+        int first = -1;
+        bool sameRow = true, sameCol = true, sameBlock = true;
+        int count = 0;
+        for(CellId cell : cells){
+            if((cellValues[cell] & bit) == 0){
+                continue;
+            }
+            ++count;
+            if(first < 0){
+                first = cell;
+                continue;
+            }
+            sameRow = sameRow && topology().cellUnits[cell][0] == topology().cellUnits[first][0];
+            sameCol = sameCol && topology().cellUnits[cell][1] == topology().cellUnits[first][1];
+            sameBlock = sameBlock && topology().cellUnits[cell][2] == topology().cellUnits[first][2];
+        }
+        // A single position is a hidden single and is handled there
+        if(count < 2){
+            continue;
+        }
+        for(int otherType = rowUnit; otherType <= blockUnit; ++otherType){
+            const bool shared = otherType == 0 ? sameRow : (otherType == 1 ? sameCol : sameBlock);
+            // Rows and columns only meet in a single cell, so only block/line pairs are interesting
+            if(!shared || otherType == type || (type != blockUnit && otherType != blockUnit)){
+                continue;
+            }
+            const int otherUnit = topology().cellUnits[first][otherType];
+            for(CellId cell : topology().units[otherUnit]){
+                if(topology().cellUnits[cell][type] != unit && (cellValues[cell] & bit)){
+                    if(!narrowCell(cell, static_cast<Mask>(~bit))){
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Naked pairs and triples: when k unsolved cells of a unit hold only k values between them,
+ * those values are taken and can be removed from every other cell of the unit.
+ *
+ * @param unit The unit to examine.
+ * @return false on a contradiction, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::applyNakedSubsets(int unit){
+    const std::array<CellId, Geometry::size>& cells = topology().units[unit];
+    // Unsolved cells small enough to be part of a pair or triple
+    std::array<CellId, Geometry::size> small;
+    int smallCount = 0;
+    for(CellId cell : cells){
+        int size = countCandidates(cellValues[cell]);
+        if(size == 2 || size == 3){
+            small[smallCount++] = cell;
+        }
+    }
+
+    for(int i=0; i<smallCount; ++i){
+        for(int j=i+1; j<smallCount; ++j){
+            const Mask pair = cellValues[small[i]] | cellValues[small[j]];
+            for(int k=j; k<smallCount; ++k){
+                // k == j stands for the pair itself, k > j adds a third cell
+                const Mask subset = k == j ? pair : static_cast<Mask>(pair | cellValues[small[k]]);
+                const int size = k == j ? 2 : 3;
+                if(countCandidates(subset) != size){
+                    continue;
+                }
+                for(CellId cell : cells){
+                    if(cell != small[i] && cell != small[j] && (k == j || cell != small[k]) && (cellValues[cell] & subset)){
+                        if(!narrowCell(cell, static_cast<Mask>(~subset))){
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Hidden pairs and triples: when k values of a unit fit in only k cells between them,
+ * those cells cannot hold any other value.
+ *
+ * @param unit The unit to examine.
+ * @return false on a contradiction, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::applyHiddenSubsets(int unit){
+    const std::array<CellId, Geometry::size>& cells = topology().units[unit];
+    // For each value, the positions (bit i stands for cells[i]) of the cells that can hold it;
+    // a unit has as many cells as there are values, so a candidate mask holds them
+    std::array<Mask, Geometry::size> positions;
+    std::array<int, Geometry::size> values;
+    int valueCount = 0;
+    for(int value=0; value<Geometry::size; ++value){
+        Mask where = 0;
+        for(int i=0; i<Geometry::size; ++i){
+            if(cellValues[cells[i]] & (Mask(1) << value)){
+                where |= static_cast<Mask>(Mask(1) << i);
+            }
+        }
+        int size = countCandidates(where);
+        if(size == 2 || size == 3){
+            positions[valueCount] = where;
+            values[valueCount++] = value;
+        }
+    }
+
+    for(int i=0; i<valueCount; ++i){
+        for(int j=i+1; j<valueCount; ++j){
+            for(int k=j; k<valueCount; ++k){
+                // k == j stands for the pair itself, k > j adds a third value
+                const Mask where = positions[i] | positions[j] | positions[k];
+                const int size = k == j ? 2 : 3;
+                if(countCandidates(where) != size){
+                    continue;
+                }
+                const Mask subset = static_cast<Mask>((Mask(1) << values[i]) | (Mask(1) << values[j]) | (Mask(1) << values[k]));
+                for(int slot=0; slot<Geometry::size; ++slot){
+                    if((where & (Mask(1) << slot)) && !narrowCell(cells[slot], subset)){
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Naked singles, the AC-3 part of the engine: every queued solved cell has its value removed from
+ * its peers, and peers solved by that are queued in turn. Only arcs into the solved cells can
+ * remove anything, so this is AC-3's arc queue reduced to the cells that need it.
+ *
+ * @return false if a contradiction was found (with all queues cleared), true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::eliminateSolved(){
+    while(solvedCount > 0){
+        const int cell = solvedQueue[--solvedCount];
+        const Mask value = cellValues[cell];
+        for(CellId peer : topology().peers[cell]){
+            if constexpr(solverStatsEnabled){
+                ++solverStats.arcsProcessed;
+            }
+            if((cellValues[peer] & value) && !narrowCell(peer, static_cast<Mask>(~value))){
+                clearPropagationQueues();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Runs the propagation engine until nothing changes. Solved cells are eliminated from their peers
+ * first (naked singles), then queued units are examined one at a time for hidden singles,
+ * intersections and naked or hidden subsets. Every change queues only the units of the changed cell,
+ * so after a guess just the affected part of the board is revisited.
+ *
+ * @return false if a contradiction was found, true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::propagate(){
+    while(true){
+        if(!eliminateSolved()){
+            return false;
+        }
+        if(unitPending == 0){
+            return true;
+        }
+        const int unit = unitQueue[unitHead];
+        unitHead = (unitHead + 1) % static_cast<int>(unitQueue.size());
+        --unitPending;
+        unitQueued[unit] = false;
+        if(!applyHiddenSingles(unit) || !applyIntersections(unit) ||
+           !applyNakedSubsets(unit) || !applyHiddenSubsets(unit)){
+            clearPropagationQueues();
+            return false;
+        }
+    }
+}
+
+/**
+ * Eliminates every solved cell from its peers, then seeds the propagation engine with every unit
+ * and runs it. On the 9x9 board the elimination is done by the whole-grid elimination kernel, which
+ * leaves no naked single pending; other board sizes queue their solved cells instead.
+ *
+ * @return false if a contradiction was found (with all queues cleared), true otherwise.
+ */
+template<int Order>
+bool BasicSudokuSolver<Order>::propagateAll(){
+    clearPropagationQueues();
+    if constexpr(Order == 3){
+        Domains eliminated = cellValues;
+        if constexpr(solverStatsEnabled){
+            ++solverStats.kernelRuns;
+        }
+        if(!eliminationKernel()(eliminated)){
+            return false;
+        }
+        // Apply the result through the trail so that it can be undone like any other change
+        for(int cell=0; cell<Geometry::cellCount; ++cell){
+            setCellValues(cell, eliminated[cell]);
+        }
+    } else {
+        for(int cell=0; cell<Geometry::cellCount; ++cell){
+            const int size = countCandidates(cellValues[cell]);
+            if(size == 0){
+                clearPropagationQueues();
+                return false;
+            }
+            if(size == 1){
+                solvedQueue[solvedCount++] = static_cast<CellId>(cell);
+            }
+        }
+    }
+    for(int unit=0; unit<Geometry::unitCount; ++unit){
+        unitQueue[unit] = static_cast<std::uint8_t>(unit);
+        unitQueued[unit] = true;
+    }
+    unitPending = Geometry::unitCount;
+    return propagate();
+}
+
+/**
+ * An improved AC3 algorithm (Enhanced Constraint Propagation). Besides removing the values of solved
+ * cells from their neighbors, it looks for hidden singles, pointing and box-line intersections and
+ * naked or hidden pairs and triples in every row, column and block. This is used to solve more
+ * complex puzzles where standard AC3 might not suffice.
+ */
+template<int Order>
+void BasicSudokuSolver<Order>::inferAC3Improved(){
+    propagateAll();
+}
+
+// The class itself is instantiated in sudokuSolver.cpp; the members defined here are instantiated
+// one by one, since a class may only be explicitly instantiated once
+#define INSTANTIATE_PROPAGATION(order) \
+    template bool BasicSudokuSolver<order>::narrowCell(int, BasicSudokuSolver<order>::Mask); \
+    template void BasicSudokuSolver<order>::clearPropagationQueues(); \
+    template bool BasicSudokuSolver<order>::applyHiddenSingles(int); \
+    template bool BasicSudokuSolver<order>::applyIntersections(int); \
+    template bool BasicSudokuSolver<order>::applyNakedSubsets(int); \
+    template bool BasicSudokuSolver<order>::applyHiddenSubsets(int); \
+    template bool BasicSudokuSolver<order>::eliminateSolved(); \
+    template bool BasicSudokuSolver<order>::propagate(); \
+    template bool BasicSudokuSolver<order>::propagateAll(); \
+    template void BasicSudokuSolver<order>::inferAC3Improved();
+
+INSTANTIATE_PROPAGATION(2)
+INSTANTIATE_PROPAGATION(3)
+INSTANTIATE_PROPAGATION(4)
+INSTANTIATE_PROPAGATION(5)
+INSTANTIATE_PROPAGATION(6)
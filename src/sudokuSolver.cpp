@@ -1,174 +1,145 @@
 #include "sudokuSolver.hpp"
-#include <iostream>
-#include <fstream>
+#include "canonicalForm.hpp"
+#include "solveCache.hpp"
+#include <algorithm>
 
-SudokuSolver::SudokuSolver() {
-    // Initialize each cell with possible values from 1 to 9
-    const std::unordered_set<int> values = {1,2,3,4,5,6,7,8,9};
-    // Populate cellIndices and cellValues for each cell in a 9x9 grid
-    for(int row=1; row<=9; row++){
-        for(int col=1; col<=9; col++){
-            std::pair<int, int> index = {row, col};
-            cellIndices.emplace(index);
-            cellValues.emplace(index, values);
-        }
-    }
-    // Assign neighbors for each cell to maintain row, column, and block relationships
-    for(const std::pair<int, int>& pair : cellIndices){
-        rowNeighbors[pair] = getRowNeighbors(pair);
-        colNeighbors[pair] = getColNeighbors(pair);
-        blockNeighbors[pair] = getBlockNeighbors(pair);
-        
-        // Combine all types of neighbors into allNeighbors for easy access
-        allNeighbors[pair].insert(rowNeighbors.at(pair).begin(), rowNeighbors.at(pair).end());
-        allNeighbors.at(pair).insert(colNeighbors.at(pair).begin(), colNeighbors.at(pair).end());
-        allNeighbors.at(pair).insert(blockNeighbors.at(pair).begin(), blockNeighbors.at(pair).end());
-    }
-    // Initialize arcs based on the current neighbors setup
-    arcs = getArcs();
+template<int Order>
+BasicSudokuSolver<Order>::BasicSudokuSolver() {
+    // Neighbors and arcs come from the shared topology, so nothing else needs building
+    solveCache = nullptr;
+    reset();
 }
 
-// Reads a Sudoku board from a string input, initializing cell values.
-void SudokuSolver::readBoard(const std::string& board) {
-    std::size_t i = 0;
-    for(int row=1; row<=9; ++row){
-        for(int col=1; col<=9; ++col){
-            std::pair<int, int> index = {row, col};
-            // Convert character to integer
-            int value = board.at(i) - '0';
-            if(value != 0){
-                // Set the cell value if not zero
-                cellValues.at(index) = {value};
-            }
-            ++i;
-        }
-    }
+// Initializes each cell with every possible value and drops all state of the last search.
+template<int Order>
+void BasicSudokuSolver<Order>::reset() {
+    cellValues.fill(Geometry::allCandidates);
+    lastSolution = cellValues;
+    trailSize = 0;
+    placementCount = 0;
+    sessionSolved = false;
+    sessionConsistent = false;
+    sessionActive = false;
+    arcQueued.fill(false);
+    clearPropagationQueues();
+    stats = SearchStats();
+    solverStats = SolverStats();
 }
 
-// Reads a Sudoku puzzle from a file input by prompting the user.
-bool SudokuSolver::readBoardFromFiles(){
-    std::string userInput;
-    std::ifstream file;
-    
-    do{
-        std::cout << "Please enter the file name(including '.txt'),\nOr enter '--exit' to leave the program:\n";
-        std::getline(std::cin, userInput);
-        
-        if(userInput == "--exit"){
-            file.close();
-            return false;
-        }
-        
-        std::cout << "\n ... loading the file ... \n";
-        std::string filePath = "Puzzles/" + userInput;
-        file.open(filePath);
-        
-        if(!file.is_open()){
-            std::cerr << "\nFailed to open the file " << userInput << " . Please check the file location/name and try again. Or enter '--exit' to leave the program.\n\n";
-        }
-    } while(!file.is_open());
-    
-    // Read the file line by line and set the values in the Sudoku grid
-    std::string line;
-    std::size_t k = 0;
-    int row = 1;
-    while(getline(file, line) && row <= 9){
-        for(int col = 1; col <=9; ++col){
-            std::pair<int, int> index = {row, col};
-            char ch = line.at(k++);
-            // Ignore '*' as placeholder for empty cells
-            if(ch != '*'){
-                int value = ch - '0';
-                cellValues.at(index) = {value};
-            }
+// Reads a Sudoku board from its compact form, initializing cell values.
+// Every cell is overwritten, so the same solver can be reused for the next puzzle.
+template<int Order>
+void BasicSudokuSolver<Order>::readBoard(const Board& board) {
+    trailSize = 0;
+    sessionActive = false;
+    if constexpr(solverStatsEnabled){
+        solverStats = SolverStats();
+    }
+    for(int cell=0; cell<Geometry::cellCount; ++cell){
+        const int value = board[cell];
+        if(value >= 1 && value <= Geometry::size){
+            // Set the cell value if it is a value of this board
+            cellValues[cell] = Geometry::candidateBit(value);
+        } else {
+            // Anything else is an empty cell
+            cellValues[cell] = Geometry::allCandidates;
         }
-        k=0;
-        ++row;
     }
-    file.close();
-    std::cout << "\nFile loaded successfully. Here is your puzzle:\n";
-    printStatus();
-    
-    std::cout << "Starts analyzing the puzzle ... \n";
-    return true;
+}
+
+// Solves the board with constraint propagation and backtracking.
+template<int Order>
+bool BasicSudokuSolver<Order>::solve() {
+    return inferAC3Guessing();
+}
+
+// Returns the candidate masks of all cells, row by row.
+template<int Order>
+const typename BasicSudokuSolver<Order>::Domains& BasicSudokuSolver<Order>::getCellValues() const {
+    return cellValues;
+}
+
+// Returns the counters of the last search.
+template<int Order>
+const SearchStats& BasicSudokuSolver<Order>::getSearchStats() const {
+    return stats;
+}
+
+// Returns the detailed statistics, all zero unless built with SUDOKU_STATS.
+template<int Order>
+const SolverStats& BasicSudokuSolver<Order>::getSolverStats() const {
+    return solverStats;
+}
+
+// Sets the cache consulted by inferAC3Guessing; it must outlive its use by this solver.
+template<int Order>
+void BasicSudokuSolver<Order>::setSolveCache(SolveCache* cache) {
+    solveCache = cache;
+}
+
+// Sets the heuristics the search uses to pick its guesses.
+template<int Order>
+void BasicSudokuSolver<Order>::setBranching(const BranchingStrategy& strategy) {
+    branching = strategy;
+}
+
+template<int Order>
+const BranchingStrategy& BasicSudokuSolver<Order>::getBranching() const {
+    return branching;
+}
+
+// Replaces the candidate masks of all cells, e.g. with a board shared by another solver.
+template<int Order>
+void BasicSudokuSolver<Order>::loadCellValues(const Domains& cells) {
+    trailSize = 0;
+    sessionActive = false;
+    cellValues = cells;
 }
 
 /**
  * Retrieves all row neighbors of a given cell excluding the cell itself.
- * This function collects all cells that are in the same row as the target cell.
+ * This function returns the cells that are in the same row as the target cell.
  *
- * @param target The cell for which to find row neighbors.
- * @return An unordered set of pairs representing the indices of the row neighbors.
+ * @param cell The cell for which to find row neighbors.
+ * @return The indices of the 8 row neighbors, taken from the precomputed topology.
  */
-std::unordered_set<std::pair<int, int>, pairHashing> SudokuSolver::getRowNeighbors(const std::pair<int, int>& target) const {
-    
-    std::unordered_set<std::pair<int, int>, pairHashing> rowNeighbors;
-    for(int row=1; row<=9; ++row){
-        rowNeighbors.emplace(row, target.second);
-    }
-    // Remove the target cell itself from its neighbors
-    rowNeighbors.erase(target);
-    return rowNeighbors;
+template<int Order>
+const typename BasicSudokuTopology<Order>::UnitPeers& BasicSudokuSolver<Order>::getRowNeighbors(int cell) const {
+    return topology().rowPeers[cell];
 }
 
 /**
  * Retrieves all column neighbors of a given cell excluding the cell itself.
- * This function collects all cells that are in the same column as the target cell.
+ * This function returns the cells that are in the same column as the target cell.
  *
- * @param target The cell for which to find column neighbors.
- * @return An unordered set of pairs representing the indices of the column neighbors.
+ * @param cell The cell for which to find column neighbors.
+ * @return The indices of the 8 column neighbors, taken from the precomputed topology.
  */
-std::unordered_set<std::pair<int, int>, pairHashing> SudokuSolver::getColNeighbors(const std::pair<int, int>& target) const {
-    
-    std::unordered_set<std::pair<int, int>, pairHashing> colNeighbors;
-    for(int col=1; col<=9; ++col){
-        colNeighbors.emplace(target.first, col);
-    }
-    // Remove the target cell itself from its neighbors
-    colNeighbors.erase(target);
-    return colNeighbors;
+template<int Order>
+const typename BasicSudokuTopology<Order>::UnitPeers& BasicSudokuSolver<Order>::getColNeighbors(int cell) const {
+    return topology().colPeers[cell];
 }
 
 /**
  * Retrieves all neighbors within the same 3x3 block of a given cell excluding the cell itself.
- * This calculates the top left corner of the block and iterates over the 3x3 grid.
  *
- * @param target The cell for which to find block neighbors.
- * @return An unordered set of pairs representing the indices of the block neighbors.
+ * @param cell The cell for which to find block neighbors.
+ * @return The indices of the 8 block neighbors, taken from the precomputed topology.
  */
-std::unordered_set<std::pair<int, int>, pairHashing> SudokuSolver::getBlockNeighbors(const std::pair<int, int>& target) const {
-    
-    std::unordered_set<std::pair<int, int>, pairHashing> blockNeighbors;
-    // Calculate starting row of the block
-    int row = (target.first - 1) - (target.first - 1) % 3;
-    // Calculate starting column of the block
-    int column = (target.second - 1) - (target.second - 1) % 3;
-    
-    for(int i=1; i<4; ++i){
-        for(int j=1; j<4; ++j){
-            blockNeighbors.emplace(row + i, column + j);
-        }
-    }
-    // Remove the target cell itself from its neighbors
-    blockNeighbors.erase(target);
-    return blockNeighbors;
+template<int Order>
+const typename BasicSudokuTopology<Order>::UnitPeers& BasicSudokuSolver<Order>::getBlockNeighbors(int cell) const {
+    return topology().blockPeers[cell];
 }
 
 /**
- * Builds the set of arcs needed for the AC-3 algorithm. An arc represents a pair of cells where
+ * Returns the arcs needed for the AC-3 algorithm. An arc represents a pair of cells where
  * one influences the possible values of the other.
  *
- * @return A set of pairs where each pair consists of two cell indices representing an arc.
+ * @return All arcs (1620 on the 9x9 board), grouped by their first cell.
  */
-std::unordered_set<std::pair<std::pair<int, int>, std::pair<int, int>>, pairOfPairHashing> SudokuSolver::getArcs(){
-    
-    for(const std::pair<int, int>& targetIndex : cellIndices){
-        std::unordered_set<std::pair<int, int>, pairHashing> neighbors = allNeighbors.at(targetIndex);
-        for(const std::pair<int, int>& neighbor : neighbors){
-            arcs.emplace(targetIndex, neighbor);
-        }
-    }
-    return arcs;
+template<int Order>
+const std::array<typename BasicSudokuTopology<Order>::Arc, BoardGeometry<Order>::arcCount>& BasicSudokuSolver<Order>::getArcs() const {
+    return topology().arcs;
 }
 
 /**
@@ -177,9 +148,10 @@ std::unordered_set<std::pair<std::pair<int, int>, std::pair<int, int>>, pairOfPa
  *
  * @return true if the puzzle is solved, false otherwise.
  */
-bool SudokuSolver::isSolved() const {
-    for(const std::pair<int, int>& index : cellIndices){
-        if(cellValues.at(index).size() != 1){
+template<int Order>
+bool BasicSudokuSolver<Order>::isSolved() const {
+    for(Mask mask : cellValues){
+        if(countCandidates(mask) != 1){
             return false;
         }
     }
@@ -191,18 +163,20 @@ bool SudokuSolver::isSolved() const {
  * cell has a determined value. This method enforces the constraint that no two
  * neighboring cells can contain the same value.
  *
- * @param index1 The cell to potentially modify.
- * @param index2 The neighboring cell which might influence index1.
+ * @param cell1 The cell to potentially modify.
+ * @param cell2 The neighboring cell which might influence cell1.
  * @return true if a value was removed, false otherwise.
  */
-bool SudokuSolver::removeInconsistentValue(const std::pair<int, int>& index1, const std::pair<int, int>& index2){
+template<int Order>
+bool BasicSudokuSolver<Order>::removeInconsistentValue(int cell1, int cell2){
     bool removed = false;
-    const std::unordered_set<int>& value2 = cellValues.at(index2);
-    // Only proceed if index2 has exactly one value (determined)
-    if(value2.size() == 1){
-        std::unordered_set<int>& value1 = cellValues.at(index1);
-        // .erase() returns 0 if the value to remove was not found, and 1 otherwise.
-        if(value1.erase(*value2.begin()) == 1){
+    const Mask value2 = cellValues[cell2];
+    // Only proceed if cell2 has exactly one value (determined)
+    if(countCandidates(value2) == 1){
+        const Mask value1 = cellValues[cell1];
+        // Clearing the bit only counts as a removal if the value was still a candidate
+        if(value1 & value2){
+            setCellValues(cell1, value1 & ~value2);
             removed = true;
         }
     }
@@ -214,217 +188,291 @@ bool SudokuSolver::removeInconsistentValue(const std::pair<int, int>& index1, co
  * by achieving arc consistency across the Sudoku grid. If a value is removed from
  * a cell's domain, it re-evaluates its neighbors to ensure consistency is maintained.
  */
-void SudokuSolver::inferAC3(){
+template<int Order>
+void BasicSudokuSolver<Order>::inferAC3(){
     
-    std::queue<std::pair<std::pair<int, int>, std::pair<int, int>>> queueArc;
+    const std::array<typename Topology::Arc, Geometry::arcCount>& arcs = getArcs();
+    // The queue holds arc positions in a fixed ring buffer. An arc already waiting is never
+    // queued twice, so at most all arcs are pending and the buffer cannot overflow.
+    std::size_t head = 0;
+    std::size_t pending = 0;
     // Initialize the queue with all existing arcs
-    for(const std::pair<std::pair<int, int>, std::pair<int, int>>& arc : arcs){
-        queueArc.push(arc);
+    for(std::size_t arc=0; arc<arcs.size(); ++arc){
+        arcQueue[arc] = static_cast<ArcId>(arc);
+        arcQueued[arc] = true;
     }
+    pending = arcs.size();
     
-    while(!queueArc.empty()){
-        const std::pair<std::pair<int, int>, std::pair<int, int>>& targetArc = queueArc.front();
-        queueArc.pop();
+    while(pending != 0){
+        const int targetArc = arcQueue[head];
+        head = (head + 1) % arcQueue.size();
+        --pending;
+        arcQueued[targetArc] = false;
+        if constexpr(solverStatsEnabled){
+            ++solverStats.arcsProcessed;
+        }
+        const int from = arcs[targetArc].from;
         // If removing an inconsistent value is successful, requeue neighbors for further consistency checks
-        if(removeInconsistentValue(targetArc.first, targetArc.second)){
-            std::unordered_set<std::pair<int, int>, pairHashing> candidates = allNeighbors.at(targetArc.first);
-            // Remove the current arc's target to prevent reciprocal checking
-            candidates.erase(targetArc.second);
-            // Re-enqueue all affected arcs
-            for(const std::pair<int, int>& candidate : candidates){
-                queueArc.push({candidate, targetArc.first});
+        if(removeInconsistentValue(from, arcs[targetArc].to)){
+            // Re-enqueue all arcs pointing at the changed cell, skipping the current arc's target to prevent reciprocal checking
+            for(int k=0; k<Geometry::peerCount; ++k){
+                const int arc = from * Geometry::peerCount + k;
+                const int affected = topology().reverseArcs[arc];
+                if(arc != targetArc && !arcQueued[affected]){
+                    arcQueue[(head + pending) % arcQueue.size()] = static_cast<ArcId>(affected);
+                    arcQueued[affected] = true;
+                    ++pending;
+                }
             }
         }
     }
 }
 
 /**
- * Validates whether a candidate number can be legally placed in a cell based on its neighbors.
- * It checks if the candidate number is already present in any of the neighboring cells' values.
+ * Records the current domain of a cell on the trail and replaces it with a narrower one.
+ * All domain changes made while solving go through here so that they can be undone.
  *
- * @param candidate The number to validate.
- * @param neighbors A set of neighbors' indices to check against the candidate.
- * @return true if the candidate is valid (not found in neighbors), false otherwise.
+ * @param cell The cell to modify.
+ * @param mask The new candidate mask, a subset of the current one.
  */
-bool SudokuSolver::isCandidateValid(int candidate, const std::unordered_set<std::pair<int, int>, pairHashing>& neighbors){
-    
-    for(const std::pair<int, int>& pair : neighbors){
-        const std::unordered_set<int>& values = cellValues.at(pair);
-        // .count() returns 0 if the element is not found, or 1 otherwise.
-        if(values.count(candidate) == 1){
-            return false;
+template<int Order>
+void BasicSudokuSolver<Order>::setCellValues(int cell, Mask mask){
+    if(cellValues[cell] != mask){
+        trail[trailSize++] = TrailEntry{static_cast<CellId>(cell), cellValues[cell]};
+        if constexpr(solverStatsEnabled){
+            solverStats.valuesRemoved += countCandidates(cellValues[cell]) - countCandidates(mask);
         }
+        cellValues[cell] = mask;
+        ++stats.propagations;
     }
-    return true;
 }
 
 /**
- * An improved AC3 algorithm that considers additional constraints by validating each candidate
- * against all neighbors before deciding to place a value. This is used to solve more complex puzzles
- * where standard AC3 might not suffice.
+ * Restores every domain changed since the trail had the given size, newest change first.
+ *
+ * @param trailMark The trail size to roll back to.
  */
-void SudokuSolver::inferAC3Improved(){
-    inferAC3();
-    std::size_t attempts = 0;
-
-    while(!isSolved()){
-        ++attempts;
-        bool convergence = true;
-        
-        std::unordered_map<std::pair<int, int>, std::unordered_set<int>, pairHashing> prevCells(cellValues);
-        // remember that keys are immutable
-        for(const std::pair<const std::pair<int, int>, std::unordered_set<int>>& pair : cellValues){
-            
-            const std::pair<int, int>& index = pair.first;
-            const std::unordered_set<int>& candidates = pair.second;
-            
-            if(candidates.size() > 1){
-                for(int candidate : candidates){
-                    if(isCandidateValid(candidate, rowNeighbors.at(index)) ||
-                       isCandidateValid(candidate, colNeighbors.at(index)) ||
-                       isCandidateValid(candidate, blockNeighbors.at(index)) ){
-                        cellValues.at(index) = {candidate};
-                        convergence = false;
-                        break;
-                    }
-                }
-            }
-            inferAC3();
-        }
-        if(convergence){
-            break;
-        }
-        std::cout << "# of attempts: " << attempts << "\n";
+template<int Order>
+void BasicSudokuSolver<Order>::undoTrail(int trailMark){
+    while(trailSize > trailMark){
+        const TrailEntry& entry = trail[--trailSize];
+        cellValues[entry.cell] = entry.mask;
     }
 }
 
-
 /**
- * Applies guessing strategies combined with the improved AC3 algorithm to solve the Sudoku.
- * It uses a backtracking approach with a priority queue to handle cells with more constraints first.
+ * Gives away all untried guesses of the shallowest guess level that still has some, since those
+ * are the roots of the largest unexplored subtrees. The board of that level is rebuilt by replaying
+ * the trail backwards onto a copy, so the running search itself is left untouched.
  *
- * @return true if the puzzle is solved, false if no solution is found.
+ * @param depth The number of open guess levels.
+ * @param control Receives one board per untried value.
  */
-bool SudokuSolver::inferAC3Guessing(){
-
-    inferAC3Improved();
-    
-    if(isSolved()){
-        return true;
-    }
-    
-    for(const std::pair<const std::pair<int, int>, std::unordered_set<int>>& cell: cellValues){
-        if(cell.second.empty()){
-            // No valid values left to assign, means it's unsolvable
-            return false;
-        }
-    }
-    
-    // This priority queue with cells based on the minimum remaining values heuristic,
-    // which prioritizes cells with the fewest possible values left.
-    std::priority_queue<std::pair<int, std::pair<int, int>>, std::vector<std::pair<int, std::pair<int, int>>>, cellComparator> minHeap;
-    
-    // Iterates through all cell indices and populate the queue
-    for(const std::pair<int, int>& index : cellIndices){
-        std::size_t size = cellValues.at(index).size();
-        if(size > 1){
-            minHeap.push({size, index});
+template<int Order>
+void BasicSudokuSolver<Order>::shareUntriedGuesses(int depth, BasicSearchControl<Order>& control){
+    for(int level=0; level<depth; ++level){
+        SearchFrame& frame = searchStack[level];
+        if(frame.untried == 0){
+            continue;
         }
-    }
-    
-    std::pair<int, int> targetCell = minHeap.top().second;
-    minHeap.pop();
-    std::unordered_set<int> candidates = cellValues.at(targetCell);
-    
-    for(int candidate : candidates){
-        std::unordered_map<std::pair<int, int>, std::unordered_set<int>, pairHashing> prevCells = cellValues;
-        // start guessing
-        cellValues.at(targetCell) = {candidate};
-        
-        if(inferAC3Guessing()){
-            return true;
+        Domains shared = cellValues;
+        for(int entry = trailSize - 1; entry >= frame.trailMark; --entry){
+            shared[trail[entry].cell] = trail[entry].mask;
         }
-        else{
-            cellValues = prevCells;
+        for(Mask rest = frame.untried; rest != 0; rest &= rest - 1){
+            shared[frame.cell] = Geometry::candidateBit(firstCandidate(rest));
+            control.shareWork(shared);
         }
+        frame.untried = 0;
+        return;
     }
-    return false;
 }
 
 /**
- * Prints the current status of the Sudoku grid. Cells with multiple possibilities are printed with their possible values.
- * Empty cells (with all possibilities) are printed as blank.
+ * Applies guessing strategies combined with the improved AC3 algorithm to solve the Sudoku.
+ * It runs an iterative backtracking search over an explicit stack of guesses. Instead of copying
+ * the board for every guess, each guess remembers the trail position it started from, and
+ * backtracking pops the trail back to that position.
+ *
+ * When a search control is given, the search stops as soon as it is cancelled and gives away
+ * its untried guesses whenever another worker asks for work. Otherwise a solve cache, if one is
+ * set, is consulted first.
+ *
+ * @param control Optional hooks for running as one worker of a parallel search.
+ * @return true if the puzzle is solved, false if no solution is found (or the search was cancelled).
  */
-void SudokuSolver::printStatus(){
-    std::cout << std::endl;
-    
-    for(const std::pair<int, int>& index : cellIndices){
-        const std::unordered_set<int>& values = cellValues.at(index);
-        if(values.size() != 9){
-            std::cout << cellValues.at(index) << " ";
-        } else {
-            std::cout << "{ } ";
-        }
-        if(index.second == 9){
-            std::cout << "\n";
-        }
+template<int Order>
+bool BasicSudokuSolver<Order>::inferAC3Guessing(BasicSearchControl<Order>* control){
+    if(solveCache != nullptr && control == nullptr){
+        return searchCached();
     }
-    std::cout << std::endl;
-}
-
-void SudokuSolver::welcomeMessage() {
-    std::cout << "\n\n";
-    std::cout << "================================================================================\n\n";
-    std::cout << " _________         .___      __          _________      .__             -v1.8.1\n";
-    std::cout << "/   _____/__ __  __| _/____ |  | ____ __/   _____/ ____ |  |___  __ ___________\n";
-    std::cout << "\\_____  \\|  |  \\/ __ |/  _ \\|  |/ /  |  \\_____  \\ /  _ \\|  |\\  \\/ // __ \\_  __ \\\n";
-    std::cout << "/        \\  |  / /_/ (  <_> )    <|  |  /        (  <_> )  |_\\   /\\  ___/|  | \\/\n";
-    std::cout << "/_______ /____/\\_____|\\____/|__|_ \\____/_______  /\\____/|____/\\_/  \\___  >__|\n";
-    std::cout << "       \\/           \\/           \\/            \\/                      \\/\n\n";
-    std::cout << "================================================================================\n";
-    std::cout << "Welcome to Sudoku solver! Let me solve the sudoku puzzle for you ... \n";
-    std::cout << "First, I need your help to load the puzzle file.\n\n";
-    
-    std::cout << "** NOTICE: Ensure that your puzzle files(.txt) are following the format correctly and placed in the 'Puzzles' folder within the project directory! **\n\n";
-}
-
-void SudokuSolver::endMessage() {
-  std::cout << "\nThank you and good bye!\n\n";
-    std::cout << "================================================================================\n";
+    return search(control, 1, nullptr) == 1;
 }
 
 /**
- * Overloads the output stream operator to print the contents of an unordered set of integers.
- * Formats the output by enclosing the integers in curly braces and listing them without commas for simplicity.
+ * Solves the board through the solve cache. The puzzle is brought into its canonical form; if a
+ * symmetric variant of it was solved before, the cached solution is mapped back to this puzzle's
+ * orientation and loaded without any search, leaving the search counters at zero. Otherwise the
+ * puzzle is searched and its solution cached. Boards that are not plain puzzles (narrowed but
+ * unsolved cells) and boards too symmetric to canonicalize cheaply are searched directly; puzzles
+ * without a solution are not cached.
+ *
+ * @return true if the puzzle is solved, false if it has no solution.
  */
-std::ostream& operator<<(std::ostream& os, const std::unordered_set<int>& set) {
-    os << "{";
-    for (const int& value : set) {
-        os << value;
+template<int Order>
+bool BasicSudokuSolver<Order>::searchCached(){
+    if constexpr(Order == 3){
+        Board puzzle;
+        for(int cell=0; cell<Geometry::cellCount; ++cell){
+            const Mask values = cellValues[cell];
+            if(values != Geometry::allCandidates && countCandidates(values) != 1){
+                return search(nullptr, 1, nullptr) == 1;
+            }
+            puzzle[cell] = static_cast<std::uint8_t>(values == Geometry::allCandidates ? 0 : firstCandidate(values));
+        }
+        Board canonical;
+        BoardSymmetry symmetry;
+        if(!canonicalizeBoard(puzzle, canonical, symmetry)){
+            return search(nullptr, 1, nullptr) == 1;
+        }
+        Board solution;
+        if(solveCache->find(canonical, solution)){
+            symmetry.invert(solution, puzzle);
+            readBoard(puzzle);
+            stats = SearchStats();
+            if constexpr(solverStatsEnabled){
+                solverStats = SolverStats();
+            }
+            return true;
+        }
+        if(search(nullptr, 1, nullptr) != 1){
+            return false;
+        }
+        this->writeBoard(puzzle);
+        symmetry.apply(puzzle, solution);
+        solveCache->insert(canonical, solution);
+        return true;
+    } else {
+        return search(nullptr, 1, nullptr) == 1;
     }
-    os << "}";
-    return os;
 }
 
-std::ostream& operator<<(std::ostream& os, const std::unordered_set<std::pair<int, int>>& set) {
-    os << "{";
-    for (const std::pair<int, int>& pair : set) {
-        os << "(" << pair.first << ", " << pair.second << "), \n";
-    }
-    os << "}";
-    return os;
+/**
+ * Counts the solutions of the board, reusing the backtracking search of inferAC3Guessing but
+ * carrying on past each solution until the limit is reached. A limit of 2 is enough to tell
+ * whether a puzzle has a unique solution.
+ *
+ * @param limit The count at which to stop searching; 0 searches the whole tree.
+ * @param solutions Optional list that receives every solution found.
+ * @return The number of solutions found, at most limit. The board holds the last one found, if any.
+ */
+template<int Order>
+std::size_t BasicSudokuSolver<Order>::countSolutions(std::size_t limit, std::vector<Domains>* solutions){
+    return search(nullptr, limit, solutions);
 }
 
 /**
- * Overloads the output stream operator to print the contents of an unordered set of pair of pairs(used for displaying arcs if needed)
- * Formats the output by enclosing the pairs in curly braces and listing them without commas for simplicity.
+ * The backtracking search behind inferAC3Guessing and countSolutions.
+ *
+ * @param control Optional hooks for running as one worker of a parallel search.
+ * @param limit The count at which to stop searching; 0 searches the whole tree.
+ * @param solutions Optional list that receives every solution found.
+ * @return The number of solutions found before the search ended, was cancelled or reached the limit.
  */
+template<int Order>
+std::size_t BasicSudokuSolver<Order>::search(BasicSearchControl<Order>* control, std::size_t limit, std::vector<Domains>* solutions){
 
-std::ostream& operator<<(std::ostream& os, const std::unordered_set<std::pair<std::pair<int, int>, std::pair<int, int>>>& set) {
-    os << "{";
-    for (const std::pair<std::pair<int, int>, std::pair<int, int>>& pair : set) {
-        os << "((" << pair.first.first << ", " << pair.first.second << "), (" << pair.second.first << ", " << pair.second.second << ")), \n";
+    trailSize = 0;
+    sessionActive = false;
+    stats = SearchStats();
+    stats.nodes = 1;
+    if constexpr(solverStatsEnabled){
+        solverStats = SolverStats();
+    }
+    int depth = 0;
+    std::size_t count = 0;
+    bool consistent;
+    {
+        PhaseTimer<> timer(solverStats, initialPropagationPhase);
+        consistent = propagateAll();
+    }
+    
+    while(true){
+        if(control != nullptr){
+            if(control->isCancelled()){
+                return count;
+            }
+            if(control->wantsWork()){
+                shareUntriedGuesses(depth, *control);
+            }
+        }
+        if(consistent){
+            if(isSolved()){
+                ++count;
+                if(solutions != nullptr){
+                    solutions->push_back(cellValues);
+                }
+                if(count == limit){
+                    return count;
+                }
+                // Keep the solution so the board can show it once the tree is exhausted
+                lastSolution = cellValues;
+            } else {
+                // Open a new guess level on the cell picked by the branching strategy
+                int targetCell;
+                {
+                    PhaseTimer<> timer(solverStats, guessSelectionPhase);
+                    targetCell = selectGuessCell();
+                }
+                searchStack[depth++] = SearchFrame{static_cast<CellId>(targetCell), cellValues[targetCell], trailSize};
+                ++stats.guesses;
+                if constexpr(solverStatsEnabled){
+                    solverStats.maxDepth = std::max(solverStats.maxDepth, depth);
+                }
+            }
+        }
+        
+        // Move on to the next untried value, backtracking through exhausted levels
+        int guessCell = 0;
+        Mask guess = 0;
+        while(true){
+            if(depth == 0){
+                // No valid values left to assign, the whole tree has been searched
+                if(count != 0){
+                    loadCellValues(lastSolution);
+                }
+                return count;
+            }
+            SearchFrame& frame = searchStack[depth - 1];
+            // A level that was just opened has no guess to undo yet
+            if constexpr(solverStatsEnabled){
+                solverStats.rollbacks += trailSize > frame.trailMark ? 1 : 0;
+            }
+            {
+                PhaseTimer<> timer(solverStats, rollbackPhase);
+                undoTrail(frame.trailMark);
+            }
+            if(frame.untried == 0){
+                --depth;
+                continue;
+            }
+            int candidate = selectGuessValue(frame);
+            frame.untried &= static_cast<Mask>(~Geometry::candidateBit(candidate));
+            // start guessing
+            guessCell = frame.cell;
+            guess = Geometry::candidateBit(candidate);
+            break;
+        }
+        
+        // Only the guessed cell has changed, so propagation starts from there
+        ++stats.nodes;
+        PhaseTimer<> timer(solverStats, guessPropagationPhase);
+        consistent = narrowCell(guessCell, guess) && propagate();
     }
-    os << "} ";
-    return os;
 }
+
+template class BasicSudokuSolver<2>;
+template class BasicSudokuSolver<3>;
+template class BasicSudokuSolver<4>;
+template class BasicSudokuSolver<5>;
+template class BasicSudokuSolver<6>;
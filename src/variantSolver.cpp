@@ -0,0 +1,339 @@
+#include "variantSolver.hpp"
+#include <string>
+
+// Compiles the classic rules, which are always valid.
+static VariantTopology classicTopology(){
+    VariantTopology topology;
+    std::string error;
+    compileVariantTopology(VariantRules(), topology, error);
+    return topology;
+}
+
+VariantSolver::VariantSolver() : VariantSolver(classicTopology()) {
+}
+
+VariantSolver::VariantSolver(const VariantTopology& variant) : topology(variant) {
+    reset();
+}
+
+// Sets the rules of the following puzzles; the board is opened again.
+void VariantSolver::setTopology(const VariantTopology& variant) {
+    topology = variant;
+    reset();
+}
+
+const VariantTopology& VariantSolver::getTopology() const {
+    return topology;
+}
+
+// Initializes each cell with every possible value and drops all state of the last search.
+void VariantSolver::reset() {
+    cellValues.fill(allCandidates);
+    lastSolution = cellValues;
+    trailSize = 0;
+    clearPropagationQueues();
+    stats = SearchStats();
+}
+
+// Reads the givens of a puzzle; every cell is overwritten, so the solver can be reused.
+void VariantSolver::readBoard(const Board& board) {
+    trailSize = 0;
+    for(int cell=0; cell<81; ++cell){
+        const int value = board[cell];
+        cellValues[cell] = value >= 1 && value <= 9 ? candidateBit(value) : allCandidates;
+    }
+}
+
+bool VariantSolver::solve() {
+    return search(1, nullptr) == 1;
+}
+
+std::size_t VariantSolver::countSolutions(std::size_t limit, std::vector<CellDomains>* solutions) {
+    return search(limit, solutions);
+}
+
+const CellDomains& VariantSolver::getCellValues() const {
+    return cellValues;
+}
+
+const SearchStats& VariantSolver::getSearchStats() const {
+    return stats;
+}
+
+void VariantSolver::queueConstraint(int constraint){
+    if(!constraintQueued[constraint]){
+        constraintQueued[constraint] = true;
+        constraintQueue[(constraintHead + constraintPending) % maxConstraints] = static_cast<std::uint8_t>(constraint);
+        ++constraintPending;
+    }
+}
+
+void VariantSolver::clearPropagationQueues(){
+    solvedCount = 0;
+    constraintHead = 0;
+    constraintPending = 0;
+    constraintQueued.fill(false);
+}
+
+/**
+ * Narrows the domain of a cell to the given values and schedules the work that follows from it:
+ * the cell's units and cage are queued for their rules, and a cell that just became solved is
+ * queued for elimination from its peers.
+ *
+ * @param cell The cell to modify.
+ * @param mask The values the cell may keep; candidates outside it are removed.
+ * @return false if the cell has no candidate left, true otherwise.
+ */
+bool VariantSolver::narrowCell(int cell, CandidateMask mask){
+    const CandidateMask current = cellValues[cell];
+    const CandidateMask narrowed = current & mask;
+    if(narrowed == current){
+        return true;
+    }
+    trail[trailSize++] = TrailEntry{static_cast<CellId>(cell), current};
+    cellValues[cell] = narrowed;
+    ++stats.propagations;
+    if(narrowed == 0){
+        return false;
+    }
+    if(countCandidates(narrowed) == 1){
+        solvedQueue[solvedCount++] = static_cast<CellId>(cell);
+    }
+    for(int index=0; index<topology.cellUnitCount[cell]; ++index){
+        queueConstraint(topology.cellUnits[cell][index]);
+    }
+    if(topology.cellCage[cell] >= 0){
+        queueConstraint(VariantTopology::maxUnits + topology.cellCage[cell]);
+    }
+    return true;
+}
+
+void VariantSolver::undoTrail(int trailMark){
+    while(trailSize > trailMark){
+        const TrailEntry& entry = trail[--trailSize];
+        cellValues[entry.cell] = entry.mask;
+    }
+}
+
+/**
+ * Places every value that fits only one cell of a unit (hidden singles).
+ *
+ * @param unit The unit.
+ * @return false if a value fits no cell of the unit, or two values only fit the same cell.
+ */
+bool VariantSolver::applyUnit(int unit){
+    const std::array<CellId, 9>& cells = topology.units[unit];
+    // Values seen in at least one cell, and in at least two cells
+    CandidateMask once = 0;
+    CandidateMask twice = 0;
+    for(CellId cell : cells){
+        twice |= once & cellValues[cell];
+        once |= cellValues[cell];
+    }
+    if(once != allCandidates){
+        return false;
+    }
+    const CandidateMask single = once & ~twice;
+    if(single == 0){
+        return true;
+    }
+    for(CellId cell : cells){
+        const CandidateMask placed = cellValues[cell] & single;
+        if(placed != 0 && (countCandidates(placed) > 1 || !narrowCell(cell, placed))){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Narrows the cells of a cage to its sum combinations that still fit. A combination fits if it
+ * holds every value already placed in the cage, every cell of the cage can take one of its values,
+ * and each of its values can go in some cell. Values that every fitting combination needs are
+ * placed in their cell when only one cell of the cage can hold them.
+ *
+ * @param cage The cage.
+ * @return false if no combination fits, or a needed value fits no cell.
+ */
+bool VariantSolver::applyCage(int cage){
+    const VariantTopology::Cage& compiled = topology.cages[cage];
+    // Values of the solved cells, values any cell can hold, and values held by two cells or more
+    CandidateMask placed = 0;
+    CandidateMask once = 0;
+    CandidateMask twice = 0;
+    for(int index=0; index<compiled.cellCount; ++index){
+        const CandidateMask values = cellValues[compiled.cells[index]];
+        if(countCandidates(values) == 1){
+            placed |= values;
+        }
+        twice |= once & values;
+        once |= values;
+    }
+    const int key = SumCombinations::key(compiled.cellCount, compiled.sum);
+    CandidateMask possible = 0;
+    CandidateMask needed = allCandidates;
+    for(int combination = sumCombinations.first[key]; combination < sumCombinations.first[key + 1]; ++combination){
+        const CandidateMask values = sumCombinations.masks[combination];
+        if((values & placed) != placed || (values & ~once) != 0){
+            continue;
+        }
+        bool fits = true;
+        for(int index=0; index<compiled.cellCount && fits; ++index){
+            fits = (cellValues[compiled.cells[index]] & values) != 0;
+        }
+        if(fits){
+            possible |= values;
+            needed &= values;
+        }
+    }
+    if(possible == 0){
+        return false;
+    }
+    const CandidateMask single = needed & ~twice;
+    for(int index=0; index<compiled.cellCount; ++index){
+        const int cell = compiled.cells[index];
+        const CandidateMask only = cellValues[cell] & single;
+        if(only != 0 && countCandidates(only) > 1){
+            return false;
+        }
+        if(!narrowCell(cell, only != 0 ? only : possible)){
+            return false;
+        }
+    }
+    return true;
+}
+
+// Removes the value of every queued solved cell from its peers, and of the cells this solves in turn.
+bool VariantSolver::eliminateSolved(){
+    while(solvedCount > 0){
+        const int cell = solvedQueue[--solvedCount];
+        const CandidateMask value = cellValues[cell];
+        const std::array<CellId, VariantTopology::maxPeers>& peers = topology.peers[cell];
+        for(int index=0; index<topology.peerCount[cell]; ++index){
+            const int peer = peers[index];
+            if((cellValues[peer] & value) && !narrowCell(peer, static_cast<CandidateMask>(~value))){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Applies the rules until nothing changes. Eliminations from solved cells come first, as the
+ * cheapest; then the queued units and cages are processed in turn.
+ *
+ * @param everything Queue every solved cell, unit and cage first, as for a new board.
+ * @return false if the board contradicts the rules, true otherwise.
+ */
+bool VariantSolver::propagate(bool everything){
+    if(everything){
+        clearPropagationQueues();
+        for(int cell=0; cell<81; ++cell){
+            if(countCandidates(cellValues[cell]) == 1){
+                solvedQueue[solvedCount++] = static_cast<CellId>(cell);
+            }
+        }
+        for(int unit=0; unit<topology.unitCount; ++unit){
+            queueConstraint(unit);
+        }
+        for(int cage=0; cage<topology.cageCount; ++cage){
+            queueConstraint(VariantTopology::maxUnits + cage);
+        }
+    }
+    while(true){
+        if(!eliminateSolved()){
+            clearPropagationQueues();
+            return false;
+        }
+        if(constraintPending == 0){
+            return true;
+        }
+        const int constraint = constraintQueue[constraintHead];
+        constraintHead = (constraintHead + 1) % maxConstraints;
+        --constraintPending;
+        constraintQueued[constraint] = false;
+        const bool consistent = constraint < VariantTopology::maxUnits ? applyUnit(constraint)
+                                                                       : applyCage(constraint - VariantTopology::maxUnits);
+        if(!consistent){
+            clearPropagationQueues();
+            return false;
+        }
+    }
+}
+
+// Picks the unsolved cell with the fewest candidates in one pass; none can have fewer than two.
+int VariantSolver::selectGuessCell() const {
+    int bestCell = -1;
+    int bestSize = 10;
+    for(int cell=0; cell<81; ++cell){
+        const int size = countCandidates(cellValues[cell]);
+        if(size > 1 && size < bestSize){
+            bestCell = cell;
+            bestSize = size;
+            if(size == 2){
+                break;
+            }
+        }
+    }
+    return bestCell;
+}
+
+/**
+ * Iterative backtracking search over the propagated board, trying the values of the cell with the
+ * fewest candidates in ascending order and rolling guesses back through the trail.
+ *
+ * @param limit Stop after this many solutions; 0 searches the whole tree.
+ * @param solutions Optional list that receives every solution found.
+ * @return The number of solutions found; the board holds the last of them, if any.
+ */
+std::size_t VariantSolver::search(std::size_t limit, std::vector<CellDomains>* solutions){
+    trailSize = 0;
+    stats = SearchStats();
+    stats.nodes = 1;
+    int depth = 0;
+    std::size_t count = 0;
+    bool consistent = propagate(true);
+
+    while(true){
+        if(consistent){
+            const int targetCell = selectGuessCell();
+            if(targetCell < 0){
+                ++count;
+                if(solutions != nullptr){
+                    solutions->push_back(cellValues);
+                }
+                if(count == limit){
+                    return count;
+                }
+                lastSolution = cellValues;
+            } else {
+                searchStack[depth++] = SearchFrame{static_cast<CellId>(targetCell), cellValues[targetCell], trailSize};
+                ++stats.guesses;
+            }
+        }
+
+        // Move on to the next untried value, backtracking through exhausted levels
+        while(true){
+            if(depth == 0){
+                if(count != 0){
+                    cellValues = lastSolution;
+                    trailSize = 0;
+                }
+                return count;
+            }
+            SearchFrame& frame = searchStack[depth - 1];
+            undoTrail(frame.trailMark);
+            if(frame.untried == 0){
+                --depth;
+                continue;
+            }
+            break;
+        }
+        SearchFrame& frame = searchStack[depth - 1];
+        const CandidateMask guess = static_cast<CandidateMask>(frame.untried & -frame.untried);
+        frame.untried &= static_cast<CandidateMask>(frame.untried - 1);
+        ++stats.nodes;
+        consistent = narrowCell(frame.cell, guess) && propagate(false);
+    }
+}
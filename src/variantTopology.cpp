@@ -0,0 +1,210 @@
+#include "variantTopology.hpp"
+#include <fstream>
+#include <sstream>
+
+bool compileVariantTopology(const VariantRules& rules, VariantTopology& topology, std::string& error){
+    if(!rules.regions.empty() && rules.regions.size() != 81){
+        error = "the regions must cover the 81 cells";
+        return false;
+    }
+    // Region of every cell, the classic blocks unless the rules give their own
+    std::array<int, 81> regions;
+    for(int cell=0; cell<81; ++cell){
+        regions[cell] = rules.regions.empty() ? (cell / 27) * 3 + (cell % 9) / 3 : rules.regions[cell];
+    }
+
+    std::array<int, 9> regionSizes{};
+    for(int cell=0; cell<81; ++cell){
+        if(regions[cell] < 0 || regions[cell] >= 9){
+            error = "regions are numbered 0 to 8";
+            return false;
+        }
+        const int region = regions[cell];
+        if(regionSizes[region] == 9){
+            error = "region " + std::to_string(region + 1) + " has more than 9 cells";
+            return false;
+        }
+        topology.units[18 + region][regionSizes[region]++] = static_cast<CellId>(cell);
+        topology.units[cell / 9][cell % 9] = static_cast<CellId>(cell);
+        topology.units[9 + cell % 9][cell / 9] = static_cast<CellId>(cell);
+        topology.cellUnits[cell] = {static_cast<std::uint8_t>(cell / 9), static_cast<std::uint8_t>(9 + cell % 9),
+                                    static_cast<std::uint8_t>(18 + region), 0, 0};
+        topology.cellUnitCount[cell] = 3;
+    }
+    topology.unitCount = 27;
+    if(rules.diagonals){
+        for(int index=0; index<9; ++index){
+            const int down = index * 10;
+            const int up = (8 - index) * 9 + index;
+            topology.units[27][index] = static_cast<CellId>(down);
+            topology.units[28][index] = static_cast<CellId>(up);
+            topology.cellUnits[down][topology.cellUnitCount[down]++] = 27;
+            topology.cellUnits[up][topology.cellUnitCount[up]++] = 28;
+        }
+        topology.unitCount = 29;
+    }
+
+    topology.cellCage.fill(-1);
+    topology.cageCount = 0;
+    for(const KillerCage& cage : rules.cages){
+        const std::size_t cellCount = cage.cells.size();
+        const std::string name = "cage " + std::to_string(topology.cageCount + 1);
+        if(cellCount == 0 || cellCount > 9){
+            error = name + " must have 1 to 9 cells";
+            return false;
+        }
+        if(cage.sum < 1 || cage.sum > SumCombinations::maxSum
+           || sumCombinations.candidates[SumCombinations::key(static_cast<int>(cellCount), cage.sum)] == 0){
+            error = name + ": no " + std::to_string(cellCount) + " distinct values add up to " + std::to_string(cage.sum);
+            return false;
+        }
+        VariantTopology::Cage& compiled = topology.cages[topology.cageCount];
+        compiled.cellCount = static_cast<std::uint8_t>(cellCount);
+        compiled.sum = static_cast<std::uint8_t>(cage.sum);
+        for(std::size_t index=0; index<cellCount; ++index){
+            const int cell = cage.cells[index];
+            if(cell < 0 || cell >= 81){
+                error = name + " has a cell outside the board";
+                return false;
+            }
+            if(topology.cellCage[cell] >= 0){
+                error = name + " shares a cell with another cage, or lists one twice";
+                return false;
+            }
+            topology.cellCage[cell] = static_cast<std::int8_t>(topology.cageCount);
+            compiled.cells[index] = static_cast<CellId>(cell);
+        }
+        ++topology.cageCount;
+    }
+
+    // Peers in ascending order, as in sudokuTopology; a cell's units and cage are marked on a scratch board
+    for(int cell=0; cell<81; ++cell){
+        std::array<bool, 81> isPeer{};
+        for(int index=0; index<topology.cellUnitCount[cell]; ++index){
+            for(CellId other : topology.units[topology.cellUnits[cell][index]]){
+                isPeer[other] = true;
+            }
+        }
+        if(topology.cellCage[cell] >= 0){
+            const VariantTopology::Cage& cage = topology.cages[topology.cellCage[cell]];
+            for(int index=0; index<cage.cellCount; ++index){
+                isPeer[cage.cells[index]] = true;
+            }
+        }
+        isPeer[cell] = false;
+        int peerCount = 0;
+        for(int other=0; other<81; ++other){
+            if(isPeer[other]){
+                topology.peers[cell][peerCount++] = static_cast<CellId>(other);
+            }
+        }
+        topology.peerCount[cell] = static_cast<std::uint8_t>(peerCount);
+    }
+    return true;
+}
+
+// Reads the 9 lines of 9 characters that follow a grid or regions section.
+static bool readRows(std::istream& file, int& lineNumber, std::string& cells){
+    cells.clear();
+    std::string line;
+    while(cells.size() < 81 && std::getline(file, line)){
+        ++lineNumber;
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        if(line.size() < 9){
+            return false;
+        }
+        cells += line.substr(0, 9);
+    }
+    return cells.size() == 81;
+}
+
+// Parses a cell written as r<row>c<col>, rows and columns from 1 to 9.
+static bool parseCell(const std::string& text, int& cell){
+    if(text.size() != 4 || (text[0] != 'r' && text[0] != 'R') || (text[2] != 'c' && text[2] != 'C')
+       || text[1] < '1' || text[1] > '9' || text[3] < '1' || text[3] > '9'){
+        return false;
+    }
+    cell = (text[1] - '1') * 9 + (text[3] - '1');
+    return true;
+}
+
+bool readVariantFile(const std::string& path, VariantRules& rules, Board& puzzle, std::string& error){
+    std::ifstream file(path);
+    if(!file.is_open()){
+        error = "failed to open " + path;
+        return false;
+    }
+    rules = VariantRules();
+    puzzle.fill(0);
+    std::string line;
+    int lineNumber = 0;
+    while(std::getline(file, line)){
+        ++lineNumber;
+        // A comment runs from # to the end of the line
+        const std::size_t comment = line.find('#');
+        if(comment != std::string::npos){
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        std::string keyword;
+        if(!(words >> keyword)){
+            continue;
+        }
+        const std::string where = path + ":" + std::to_string(lineNumber) + ": ";
+        if(keyword == "diagonals"){
+            rules.diagonals = true;
+        } else if(keyword == "grid"){
+            std::string cells;
+            if(!readRows(file, lineNumber, cells)){
+                error = where + "a grid needs 9 lines of 9 characters";
+                return false;
+            }
+            for(int cell=0; cell<81; ++cell){
+                puzzle[cell] = static_cast<std::uint8_t>(symbolValue(cells[cell], 9));
+            }
+        } else if(keyword == "regions"){
+            std::string cells;
+            if(!readRows(file, lineNumber, cells)){
+                error = where + "regions need 9 lines of 9 labels";
+                return false;
+            }
+            // Regions are numbered in the order their labels first appear
+            std::string labels;
+            rules.regions.assign(81, 0);
+            for(int cell=0; cell<81; ++cell){
+                std::size_t label = labels.find(cells[cell]);
+                if(label == std::string::npos){
+                    label = labels.size();
+                    labels += cells[cell];
+                }
+                rules.regions[cell] = static_cast<int>(label);
+            }
+            if(labels.size() != 9){
+                error = where + "regions need 9 different labels";
+                return false;
+            }
+        } else if(keyword == "cage"){
+            KillerCage cage;
+            std::string cell;
+            if(!(words >> cage.sum)){
+                error = where + "a cage starts with its sum";
+                return false;
+            }
+            while(words >> cell){
+                int index = 0;
+                if(!parseCell(cell, index)){
+                    error = where + "cells are written r<row>c<col>, not '" + cell + "'";
+                    return false;
+                }
+                cage.cells.push_back(index);
+            }
+            rules.cages.push_back(cage);
+        } else {
+            error = where + "unknown section '" + keyword + "'";
+            return false;
+        }
+    }
+    return true;
+}